@@ -0,0 +1,148 @@
+// times router construction and lookups under each allocation mode on a random graph,
+// then the runtime-sized router against the small network one on transport-shaped graphs;
+// usage: router_benchmark [vertex_count] [query_count]
+#include "../graph.h"
+#include "../mapped_allocator.h"
+#include "../router.h"
+
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace{
+
+	// kernel's count of anonymous memory backed by huge pages, in kB
+	size_t ReadAnonHugePages(){
+		std::ifstream smaps("/proc/self/smaps_rollup");
+		std::string key;
+		size_t value = 0;
+		while (smaps >> key >> value){
+			if (key == "AnonHugePages:"sv){
+				return value;
+			}
+			smaps.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		}
+		return 0;
+	}
+
+	graph::DirectedWeightedGraph<double> MakeGraph(size_t vertex_count){
+		constexpr size_t OUT_DEGREE = 4;
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+		std::uniform_real_distribution<double> weight(1.0, 100.0);
+		graph::DirectedWeightedGraph<double> result(vertex_count);
+		for (size_t from = 0; from < vertex_count; ++from){
+			for (size_t k = 0; k < OUT_DEGREE; ++k){
+				result.AddEdge({from, vertex(generator), weight(generator)});
+			}
+		}
+		return result;
+	}
+
+	// a wait edge per stop and buses linking every stop of their route to every later one,
+	// as TransportRouter lays them out; stops' start_wait vertices are the terminals
+	graph::DirectedWeightedGraph<double> MakeTransportGraph(size_t stop_count, std::vector<graph::VertexId>& terminals){
+		constexpr size_t BUS_STOP_COUNT = 10;
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<size_t> stop(0, stop_count - 1);
+		std::uniform_real_distribution<double> weight(1.0, 30.0);
+		graph::DirectedWeightedGraph<double> result(stop_count * 2);
+		terminals.clear();
+		for (size_t s = 0; s < stop_count; ++s){
+			result.AddEdge({s * 2, s * 2 + 1, 6.0});
+			terminals.push_back(s * 2);
+		}
+		for (size_t bus = 0; bus < stop_count / 2 + 1; ++bus){
+			std::vector<size_t> stops(BUS_STOP_COUNT);
+			for (size_t& s : stops){
+				s = stop(generator);
+			}
+			for (size_t i = 0; i < stops.size(); ++i){
+				double time = 0.0;
+				for (size_t j = i + 1; j < stops.size(); ++j){
+					time += weight(generator);
+					result.AddEdge({stops[i] * 2 + 1, stops[j] * 2, time});
+				}
+			}
+		}
+		return result;
+	}
+
+	template <size_t MaxVertices>
+	double TimeRouterBuild(const graph::DirectedWeightedGraph<double>& graph, const std::vector<graph::VertexId>& terminals,
+			size_t repeat_count, double& checksum){
+		using Clock = std::chrono::steady_clock;
+		const auto start = Clock::now();
+		for (size_t i = 0; i < repeat_count; ++i){
+			const graph::Router<double, MaxVertices> router(graph, terminals);
+			checksum += router.GetRouteWeight(terminals.front(), terminals.back()).value_or(0.0);
+		}
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / repeat_count;
+	}
+
+	void RunSmallNetworks(){
+		memory::SetAllocationMode(memory::AllocationMode::DEFAULT);
+		for (const size_t stop_count : {10, 40, 100, 200, 255}){
+			std::vector<graph::VertexId> terminals;
+			const graph::DirectedWeightedGraph<double> graph = MakeTransportGraph(stop_count, terminals);
+			const size_t repeat_count = 20'000'000 / (stop_count * stop_count * stop_count) + 1;
+			double checksum = 0.0;
+			const double dynamic_time = TimeRouterBuild<graph::DYNAMIC_VERTEX_COUNT>(graph, terminals, repeat_count, checksum);
+			const double small_time = TimeRouterBuild<255>(graph, terminals, repeat_count, checksum);
+			std::cout << stop_count << " stops: build dynamic "sv << dynamic_time << " us, small network "sv
+					<< small_time << " us (checksum "sv << checksum << ")\n"sv;
+		}
+	}
+
+	void Run(std::string_view name, memory::AllocationMode mode, size_t vertex_count, size_t query_count){
+		using Clock = std::chrono::steady_clock;
+		memory::SetAllocationMode(mode);
+		const memory::AllocationStats before = memory::GetAllocationStats();
+		const size_t huge_pages_before = ReadAnonHugePages();
+
+		const auto build_start = Clock::now();
+		const graph::DirectedWeightedGraph<double> graph = MakeGraph(vertex_count);
+		const graph::Router<double> router(graph);
+		const auto build_end = Clock::now();
+
+		std::mt19937 generator(7);
+		std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+		double checksum = 0.0;
+		for (size_t i = 0; i < query_count; ++i){
+			checksum += router.GetRouteWeight(vertex(generator), vertex(generator)).value_or(0.0);
+		}
+		const auto query_end = Clock::now();
+
+		const memory::AllocationStats after = memory::GetAllocationStats();
+		const size_t huge_pages_after = ReadAnonHugePages();
+		std::cout << name << ": build "sv
+				<< std::chrono::duration<double, std::milli>(build_end - build_start).count() << " ms, "sv
+				<< query_count << " lookups "sv
+				<< std::chrono::duration<double, std::milli>(query_end - build_end).count() << " ms; mapped as heap "sv
+				<< after.heap_bytes - before.heap_bytes << ", mmap "sv << after.mmap_bytes - before.mmap_bytes
+				<< ", thp "sv << after.transparent_huge_page_bytes - before.transparent_huge_page_bytes
+				<< ", hugetlb "sv << after.huge_page_bytes - before.huge_page_bytes
+				<< " bytes; AnonHugePages +"sv << (huge_pages_after > huge_pages_before ? huge_pages_after - huge_pages_before : 0)
+				<< " kB (checksum "sv << checksum << ")\n"sv;
+	}
+}
+
+int main(int argc, char* argv[]){
+	const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 1000;
+	const size_t query_count = argc > 2 ? std::stoul(argv[2]) : 20'000'000;
+
+	Run("default"sv, memory::AllocationMode::DEFAULT, vertex_count, query_count);
+	Run("mmap"sv, memory::AllocationMode::MMAP, vertex_count, query_count);
+	Run("transparent_huge_pages"sv, memory::AllocationMode::TRANSPARENT_HUGE_PAGES, vertex_count, query_count);
+	Run("huge_pages"sv, memory::AllocationMode::HUGE_PAGES, vertex_count, query_count);
+
+	RunSmallNetworks();
+}
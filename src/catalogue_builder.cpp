@@ -0,0 +1,82 @@
+#include "catalogue_builder.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace transport_catalogue{
+
+	namespace{
+		// leaves one item per name, in the place of its first occurrence and holding the last one
+		template <typename Item, typename GetName>
+		void KeepLastByName(std::vector<Item>& items, GetName get_name){
+			std::unordered_map<std::string_view, size_t> positions;
+			positions.reserve(items.size());
+			size_t count = 0;
+			for (size_t i = 0; i < items.size(); ++i){
+				const auto [position, inserted] = positions.emplace(get_name(items[i]), count);
+				if (!inserted){
+					items[position->second] = std::move(items[i]);
+				}
+				else if (count++ != i){
+					items[count - 1] = std::move(items[i]);
+				}
+			}
+			items.resize(count);
+		}
+	}
+
+	CatalogueBuilder::CatalogueBuilder(size_t stop_count, size_t bus_count, bool compute_statistics)
+		: compute_statistics_(compute_statistics){
+		catalogue_.Reserve(stop_count, bus_count);
+		stop_distances_.reserve(stop_count);
+		buses_.reserve(bus_count);
+		bus_stop_ids_.reserve(bus_count);
+	}
+
+	void CatalogueBuilder::AddStops(std::vector<Stop> stops){
+		KeepLastByName(stops, [](const Stop& stop){
+			return stop.name;
+		});
+		for (const Stop& stop : stops){
+			catalogue_.AddStop(stop);
+		}
+		stop_distances_.resize(catalogue_.GetStops().size());
+	}
+
+	void CatalogueBuilder::AddDistances(const std::vector<Distance>& distances){
+		for (const Distance& distance : distances){
+			stop_distances_[distance.from_id].push_back({distance.to_id, distance.distance});
+		}
+	}
+
+	void CatalogueBuilder::AddRoutes(std::vector<Route> routes){
+		KeepLastByName(routes, [](const Route& route){
+			return route.bus.name;
+		});
+		for (Route& route : routes){
+			buses_.push_back(std::move(route.bus));
+			bus_stop_ids_.push_back(std::move(route.stop_ids));
+		}
+	}
+
+	void CatalogueBuilder::SetSortedIds(std::vector<uint32_t> stop_ids, std::vector<uint32_t> bus_ids){
+		catalogue_.SetSortedIds(std::move(stop_ids), std::move(bus_ids));
+	}
+
+	void CatalogueBuilder::SetNameHashes(NameHash stop_names, NameHash bus_names){
+		catalogue_.SetNameHashes(std::move(stop_names), std::move(bus_names));
+	}
+
+	const Stop* CatalogueBuilder::FindStop(std::string_view stop_name) const{
+		return catalogue_.FindStop(stop_name);
+	}
+
+	TransportCatalogue CatalogueBuilder::Build(){
+		// route lengths need every distance, so both wait until here
+		catalogue_.SetDistances(std::move(stop_distances_));
+		catalogue_.AddRoutes(std::move(buses_), std::move(bus_stop_ids_), compute_statistics_);
+		catalogue_.BuildIndex();
+		return std::move(catalogue_);
+	}
+}
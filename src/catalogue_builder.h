@@ -0,0 +1,54 @@
+#pragma once
+#include "domain.h"
+#include "perfect_hash.h"
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue{
+
+	// bulk loading of a catalogue: containers are sized by the counts given up front,
+	// stops get ids in the order they are added and distances and routes refer to them by id;
+	// a name repeated within one call keeps the id of its first stop or route and the data
+	// of its last one, so the last definition wins as it did in the old name maps
+	class CatalogueBuilder{
+	public:
+		struct Distance{
+			uint32_t from_id;
+			uint32_t to_id;
+			int distance;
+		};
+
+		struct Route{
+			Bus bus; // stop_count is set from stop_ids
+			std::vector<uint32_t> stop_ids;
+		};
+
+		// statistics already present in the routes, e.g. read from a base, may be kept as is
+		CatalogueBuilder(size_t stop_count, size_t bus_count, bool compute_statistics = true);
+
+		void AddStops(std::vector<Stop> stops);
+		// a later distance between the same stops replaces an earlier one
+		void AddDistances(const std::vector<Distance>& distances);
+		void AddRoutes(std::vector<Route> routes);
+		// stored name orderings and hashes, computed by Build unless set
+		void SetSortedIds(std::vector<uint32_t> stop_ids, std::vector<uint32_t> bus_ids);
+		void SetNameHashes(NameHash stop_names, NameHash bus_names);
+		// resolves names of the added stops to ids
+		const Stop* FindStop(std::string_view stop_name) const;
+
+		// resolves distances, computes route lengths and the index; the builder is left empty
+		TransportCatalogue Build();
+
+	private:
+		TransportCatalogue catalogue_;
+		bool compute_statistics_;
+		// by source stop id, in the order given
+		std::vector<std::vector<detail::StopDistance>> stop_distances_;
+		std::vector<Bus> buses_;
+		std::vector<std::vector<uint32_t>> bus_stop_ids_;
+	};
+}
@@ -2,25 +2,45 @@
 
 #include "geo.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace transport_catalogue{
 
+	// names are views into GetNamePool(), interned when added to the catalogue
 	struct Stop{
-		std::string name;
+		std::string_view name;
 		geo::Coordinates coordinates;
+		uint32_t id = 0;
 	};
 
 	class Bus{
 	public:
-		std::string name;
-		std::vector<Stop*> stops;
+		std::string_view name;
+		// number of stops as given, their ids are in TransportCatalogue::GetBusStopIds;
+		// a linear route returns along them, see GetStopPosition
+		size_t stop_count = 0;
+		// road distance from the first stop to each route position, missing distances count as 0
+		std::vector<int> cumulative_distances;
 		size_t unique_stops = 0;
 		size_t stops_on_route = 0;
-		double length_by_coordinates;
-		double factual_length;
+		double length_by_coordinates = 0.0;
+		double factual_length = 0.0;
+		double curvature = 0.0;
 		bool is_round = false;
+		uint32_t id = 0;
+
+		// stops along the whole route, the return leg of a linear route included
+		size_t GetRouteStopCount() const{
+			return is_round || stop_count == 0 ? stop_count : stop_count * 2 - 1;
+		}
+
+		// position among the stops as given, route positions past them walk them backwards
+		size_t GetStopPosition(size_t route_position) const{
+			return route_position < stop_count ? route_position : 2 * (stop_count - 1) - route_position;
+		}
 	};
 
 	inline bool operator ==(const Stop& lhs, const Stop& rhs){
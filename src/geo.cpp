@@ -2,6 +2,7 @@
 
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace geo {
@@ -10,6 +11,26 @@ namespace geo {
 		const double dr = M_PI / 180.0;
 		return acos(sin(from.lat * dr) * sin(to.lat * dr)
 					+ cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-			* 6371000;
+			* EARTH_RADIUS;
+	}
+
+	SpherePoint ToSpherePoint(Coordinates coordinates) {
+		const double dr = M_PI / 180.0;
+		const double cos_lat = std::cos(coordinates.lat * dr);
+		return {cos_lat * std::cos(coordinates.lng * dr), cos_lat * std::sin(coordinates.lng * dr), std::sin(coordinates.lat * dr)};
+	}
+
+	void ComputePathDistances(const SpherePoint* points, size_t count, double* distances) {
+		if (count < 2) {
+			return;
+		}
+		// plain arithmetic over the cached vectors, the compiler may vectorize this loop
+		for (size_t i = 0; i + 1 < count; ++i) {
+			const double dot = points[i].x * points[i + 1].x + points[i].y * points[i + 1].y + points[i].z * points[i + 1].z;
+			distances[i] = std::clamp(dot, -1.0, 1.0);
+		}
+		for (size_t i = 0; i + 1 < count; ++i) {
+			distances[i] = std::acos(distances[i]) * EARTH_RADIUS;
+		}
 	}
 }
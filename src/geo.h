@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace geo {
 
 	struct Coordinates {
@@ -7,5 +9,24 @@ namespace geo {
 		double lng;
 	};
 
+	constexpr double EARTH_RADIUS = 6371000;
+
 	double ComputeDistance(Coordinates from, Coordinates to);
+
+	// coordinates as a unit vector, caches the trigonometry of ComputeDistance
+	struct SpherePoint {
+		double x;
+		double y;
+		double z;
+	};
+
+	SpherePoint ToSpherePoint(Coordinates coordinates);
+
+	// ComputeDistance is ill-conditioned for short segments, both versions agree within this many meters;
+	// tests/geo_test.cpp checks it over random and very short segments
+	constexpr double BATCH_DISTANCE_TOLERANCE = 0.25;
+
+	// distances[i] = distance between points[i] and points[i + 1], count - 1 values are written;
+	// the dot products vectorize, the acos pass stays scalar
+	void ComputePathDistances(const SpherePoint* points, size_t count, double* distances);
 }
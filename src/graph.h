@@ -1,8 +1,12 @@
 #pragma once
 
+#include "mapped_allocator.h"
 #include "ranges.h"
 
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -26,15 +30,23 @@ namespace graph {
 	public:
 		DirectedWeightedGraph() = default;
 		explicit DirectedWeightedGraph(size_t vertex_count);
+		VertexId AddVertex();
 		EdgeId AddEdge(const Edge<Weight>& edge);
 
 		size_t GetVertexCount() const;
 		size_t GetEdgeCount() const;
-		const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+		Edge<Weight> GetEdge(EdgeId edge_id) const;
 		IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 	private:
-		std::vector<Edge<Weight>> edges_;
+		// endpoints are kept as 32-bit ids, so an edge with double weight takes 16 bytes
+		struct StoredEdge {
+			std::uint32_t from;
+			std::uint32_t to;
+			Weight weight;
+		};
+
+		std::vector<StoredEdge, memory::MappedAllocator<StoredEdge>> edges_;
 		std::vector<IncidenceList> incidence_lists_;
 	};
 
@@ -43,12 +55,21 @@ namespace graph {
 		: incidence_lists_(vertex_count) {
 	}
 
+	template <typename Weight>
+	VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+		incidence_lists_.emplace_back();
+		return incidence_lists_.size() - 1;
+	}
+
 	template <typename Weight>
 	EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-		edges_.push_back(edge);
-		const EdgeId id = edges_.size() - 1;
-		incidence_lists_.at(edge.from).push_back(id);
-		return id;
+		if (edge.from > std::numeric_limits<std::uint32_t>::max()
+			|| edge.to > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::length_error("Vertex id does not fit into edge storage");
+		}
+		incidence_lists_.at(edge.from).push_back(edges_.size());
+		edges_.push_back({static_cast<std::uint32_t>(edge.from), static_cast<std::uint32_t>(edge.to), edge.weight});
+		return edges_.size() - 1;
 	}
 
 	template <typename Weight>
@@ -62,8 +83,9 @@ namespace graph {
 	}
 
 	template <typename Weight>
-	const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-		return edges_.at(edge_id);
+	Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+		const StoredEdge& edge = edges_.at(edge_id);
+		return {edge.from, edge.to, edge.weight};
 	}
 
 	template <typename Weight>
@@ -1,17 +1,61 @@
 #include "json_reader.h"
+#include "catalogue_builder.h"
 #include "graph.h"
+#include "json_builder.h"
+#include "mapped_allocator.h"
 #include "serialization.h"
-
+#include "snapshot.h"
+
+#include <algorithm>
+#include <execution>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <utility>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <fstream>
+#include <iostream>
 
 using namespace std::literals;
 
 namespace reader{
 	const json::Node node;
 
+	namespace{
+		// "file" is one base, or an object of city names to bases
+		std::vector<std::pair<std::string, std::string>> GetCityFiles(const json::Node& serialization_settings){
+			const json::Node& file = serialization_settings.AsMap().at("file"s);
+			if (file.IsString()){
+				return {{""s, file.AsString()}};
+			}
+			std::vector<std::pair<std::string, std::string>> result;
+			for (const auto& [city, city_file] : file.AsMap()){
+				result.emplace_back(city, city_file.AsString());
+			}
+			return result;
+		}
+
+		// builds the next version of a shard off to the side from "file", or the shard's own base,
+		// publishes it and frees the replaced version unless a reader still pins it;
+		// a base that can not be read leaves the current version in place
+		json::Node ReloadShard(transport_catalogue::CatalogueStore& shard, const json::Dict& request_map,
+				const std::string& shard_file){
+			const std::string& file = request_map.count("file"s) ? request_map.at("file"s).AsString() : shard_file;
+			const int id = request_map.at("id"s).AsInt();
+			const auto database = LoadBaseFile(file);
+			if (!database){
+				return json::Builder{}.StartDict().Key("request_id"s).Value(id)
+						.Key("error_message"s).Value("not found"s).EndDict().Build();
+			}
+			const uint64_t version = shard.Publish(std::make_unique<transport_catalogue::CatalogueSnapshot>(*database));
+			shard.Reclaim();
+			return json::Builder{}.StartDict().Key("request_id"s).Value(id)
+					.Key("version"s).Value(static_cast<int>(version)).EndDict().Build();
+		}
+	}
+
 	const json::Node& JsonReader::GetBaseRequest(){
 		if (input_.GetRoot().AsMap().count("base_requests"s)){
 			return input_.GetRoot().AsMap().at("base_requests"s);
@@ -47,116 +91,117 @@ namespace reader{
 		return node;
 	}
 
+	const json::Node& JsonReader::GetRouteCacheSettings(){
+		if (input_.GetRoot().AsMap().count("route_cache_settings"s)){
+			return input_.GetRoot().AsMap().at("route_cache_settings"s);
+		}
+		return node;
+	}
+
+	const json::Node& JsonReader::GetMemorySettings(){
+		if (input_.GetRoot().AsMap().count("memory_settings"s)){
+			return input_.GetRoot().AsMap().at("memory_settings"s);
+		}
+		return node;
+	}
+
 	void JsonReader::FillCatalogue(transport_catalogue::TransportCatalogue& transport_catalogue) {
 
 		const json::Array& arr = GetBaseRequest().AsArray();
 
-		std::unordered_map<std::pair<std::string, std::string>, int, transport_catalogue::detail::StringPairHash> distances;
-		std::unordered_map<std::string, std::vector<std::string>> bus_to_stops;
-		std::unordered_map<std::string, bool> bus_to_circle;
+		// stops go first, so distances and routes can refer to them by id
+		std::vector<transport_catalogue::Stop> stops;
+		for (const auto& request_node : arr){
+			const json::Dict& request_map = request_node.AsMap();
+			if (request_map.at("type"s).AsString() == "Stop"s){
+				stops.push_back({request_map.at("name"s).AsString(),
+					{request_map.at("latitude"s).AsDouble(), request_map.at("longitude"s).AsDouble()}});
+			}
+		}
 
+		transport_catalogue::CatalogueBuilder builder(stops.size(), arr.size() - stops.size());
+		builder.AddStops(std::move(stops));
+
+		std::vector<transport_catalogue::CatalogueBuilder::Distance> distances;
+		std::vector<transport_catalogue::CatalogueBuilder::Route> routes;
+		routes.reserve(arr.size());
 		for (const auto& request_node : arr){
 			const json::Dict& request_map = request_node.AsMap();
 			const std::string& name = request_map.at("name"s).AsString();
 
 			if (request_map.at("type"s).AsString() == "Stop"s){
-
-				// ADD STOPS
-				transport_catalogue.AddStop({name,
-					{request_map.at("latitude"s).AsDouble(), request_map.at("longitude"s).AsDouble()}});
-
-				const json::Dict& near_stops = request_map.at("road_distances"s).AsMap();
-				for (const auto& [key_stop_name, val_dist_node] : near_stops){
-					distances[std::make_pair(name, key_stop_name)] = val_dist_node.AsInt();
+				const uint32_t from_id = builder.FindStop(name)->id;
+				for (const auto& [key_stop_name, val_dist_node] : request_map.at("road_distances"s).AsMap()){
+					const auto found_stop = builder.FindStop(key_stop_name);
+					if (found_stop != nullptr){
+						distances.push_back({from_id, found_stop->id, val_dist_node.AsInt()});
+					}
 				}
 			}else if (request_map.at("type"s).AsString() == "Bus"s){
 				const json::Array& bus_stops = request_map.at("stops"s).AsArray();
-				const size_t stops_count = bus_stops.size();
-				const bool is_round = request_map.at("is_roundtrip"s).AsBool();
-
-				bus_to_circle[name] = is_round;
-
-				if (stops_count != 0 ){
-					bus_to_stops[name]
-								 .reserve(is_round ? stops_count : stops_count * 2);
 
-					for (size_t i = 0; i < bus_stops.size(); ++i){
-						bus_to_stops.at(name)
-								.emplace_back(bus_stops[i].AsString());
-
-						if ((i == bus_stops.size() - 1) && !is_round){
-							for (int j = bus_to_stops.at(name).size() - 2; j >= 0; --j){
-								bus_to_stops.at(name)
-										.emplace_back(bus_to_stops.at(name)[j]);
-							}
-						}
+				transport_catalogue::CatalogueBuilder::Route route;
+				route.bus.name = name;
+				route.bus.is_round = request_map.at("is_roundtrip"s).AsBool();
+				// the return leg of a linear route is not stored, see Bus::GetStopPosition
+				route.stop_ids.reserve(bus_stops.size());
+				for (const auto& bus_stop : bus_stops){
+					const auto found_stop = builder.FindStop(bus_stop.AsString());
+					if (found_stop != nullptr){
+						route.stop_ids.push_back(found_stop->id);
 					}
-				}else{
-					bus_to_stops[name] = {};
 				}
+				routes.push_back(std::move(route));
 			}
 		}
 
-		// SET DISTANCES
-		transport_catalogue.SetDistances(distances);
-
-		// ADD ROUTES
-		for (const auto& [name, stop_names] : bus_to_stops){
-
-			// NEEDED FOR MAP_RENDERER
-			std::vector<transport_catalogue::Stop*> stop_ptrs;
-			stop_ptrs.reserve(stop_names.size());
-			for (const auto& stop : stop_names){
-				const auto found_stop = transport_catalogue.FindStop(stop);
-				if (found_stop != nullptr){
-					stop_ptrs.push_back(found_stop);
-				}
-			}
-
-			transport_catalogue::Bus bus;
-			bus.name = name;
-			bus.stops = stop_ptrs;
-			bus.is_round = bus_to_circle.at(name);
-			transport_catalogue.AddRoute(bus);
-		}
+		builder.AddDistances(distances);
+		builder.AddRoutes(std::move(routes));
+		transport_catalogue = builder.Build();
 	}
 
 	void JsonReader::FillRouter(const transport_catalogue::TransportCatalogue& db_,
 			transport_catalogue::TransportRouter& router_){
+		// bus edges find their vertexes by stop id, not by name
+		std::vector<transport_catalogue::detail::Vertexes> stop_vertexes(db_.GetStopCount());
 		for (const auto& stop : db_.GetStops()){
-			router_.AddStop(stop.name);
+			stop_vertexes[stop.id] = router_.AddStop(stop.name);
 			router_.AddWaitEdge(stop.name);
 		}
-		for (const auto& bus : db_.GetBuses()){
-			for (size_t i = 0; i < bus.stops.size() - 1; ++i){
-				const auto stop_from = bus.stops[i];
-				auto prev_stop = stop_from;
-
-				int prev_actual = 0;
-				for (size_t j = i + 1; j < bus.stops.size(); ++j){
-					const auto stop_to = bus.stops[j];
-					int actual = 0;
-
-					if (db_.GetDistance({prev_stop, stop_to}).has_value()){
-						actual = db_.GetDistance({prev_stop, stop_to}).value();
-					}else{ // has no value from -> to
-						if (db_.GetDistance({stop_to, prev_stop}).has_value()){
-							actual = db_.GetDistance({stop_to, prev_stop}).value();
-						}
-					}
 
-					router_.AddBusEdge(
-							stop_from->name,
-							stop_to->name,
-							bus.name,
+		// edges of a bus are laid out after the edges of all previous buses, so
+		// buses fill their own slices in parallel and ids match the serial order
+		const auto& buses = db_.GetBuses();
+		std::vector<size_t> bus_ids(buses.size());
+		std::vector<uint32_t> bus_name_ids(buses.size());
+		std::vector<size_t> edge_offsets(buses.size() + 1, 0);
+		for (size_t b = 0; b < buses.size(); ++b){
+			const size_t stops_count = buses[b].GetRouteStopCount();
+			bus_ids[b] = b;
+			bus_name_ids[b] = router_.GetNameId(buses[b].name);
+			edge_offsets[b + 1] = edge_offsets[b] + (stops_count > 1 ? stops_count * (stops_count - 1) / 2 : 0);
+		}
+
+		std::vector<transport_catalogue::detail::RouterEdge> edges(edge_offsets.back());
+		std::for_each(std::execution::par, bus_ids.begin(), bus_ids.end(), [&](const size_t b){
+			const auto& bus = buses[b];
+			const uint32_t* stop_ids = db_.GetBusStopIds(bus.id).begin();
+			size_t edge_id = edge_offsets[b];
+			const size_t stops_count = bus.GetRouteStopCount();
+			for (size_t i = 0; i + 1 < stops_count; ++i){
+				const auto& stop_from = stop_vertexes[stop_ids[bus.GetStopPosition(i)]];
+				for (size_t j = i + 1; j < stops_count; ++j){
+					edges[edge_id++] = router_.MakeBusEdge(
+							stop_from,
+							stop_vertexes[stop_ids[bus.GetStopPosition(j)]],
+							bus_name_ids[b],
 							j - i,
-							prev_actual + actual
+							db_.GetRouteDistance(bus, i, j)
 						);
-					prev_stop = stop_to;
-					prev_actual += actual;
 				}
 			}
-		}
+		});
+		router_.AddEdges(edges);
 
 		router_.Build();
 	}
@@ -164,16 +209,57 @@ namespace reader{
 	void SaveBase(const transport_catalogue::TransportCatalogue& transport_catalogue,
 			const transport_catalogue::renderer::MapRenderer& map_renderer,
 			const transport_catalogue::TransportRouter& transport_router,
+			const transport_catalogue::RouteCache& route_cache,
 			const json::Node& serialization_settings){
 
         std::ofstream out(serialization_settings.AsMap().at("file"s).AsString(), std::ios::binary);
         if (out.is_open()){
-			tcs::Serialize(transport_catalogue, map_renderer, transport_router, out);
+			tcs::Serialize(transport_catalogue, map_renderer, transport_router, route_cache, out);
+		}
+	}
+
+	transport_catalogue::RouteCache BuildRouteCache(const transport_catalogue::TransportRouter& transport_router,
+			const json::Node& route_cache_settings){
+		transport_catalogue::RouteCache route_cache;
+		if (route_cache_settings.IsNull()){
+			return route_cache;
+		}
+
+		const json::Dict& settings_map = route_cache_settings.AsMap();
+		std::ifstream log(settings_map.at("query_log"s).AsString());
+		if (!log.is_open()){
+			return route_cache;
+		}
+		reader::JsonReader query_log(json::Load(log));
+		const json::Node& stat_requests = query_log.GetStatRequest();
+		if (stat_requests.IsNull()){
+			return route_cache;
+		}
+
+		const size_t max_routes = settings_map.count("max_routes"s)
+				? settings_map.at("max_routes"s).AsInt() : 1000;
+		route_cache.Build(transport_catalogue::MostFrequentRoutes(stat_requests, max_routes), transport_router);
+		return route_cache;
+	}
+
+	void ApplyMemorySettings(const json::Node& memory_settings){
+		if (!memory_settings.IsNull() && memory_settings.AsMap().count("allocation"s)){
+			memory::SetAllocationMode(memory::ParseAllocationMode(
+					memory_settings.AsMap().at("allocation"s).AsString()));
+		}
+	}
+
+	// "report": true prints how the routing arrays were actually mapped to stderr
+	void ReportMemoryUsage(const json::Node& memory_settings){
+		if (!memory_settings.IsNull() && memory_settings.AsMap().count("report"s)
+				&& memory_settings.AsMap().at("report"s).AsBool()){
+			memory::PrintAllocationStats(std::cerr);
 		}
 	}
 
 	void MakeBase(transport_catalogue::TransportCatalogue& transport_catalogue, std::istream& in_json){
 		reader::JsonReader input_json(json::Load(in_json));
+		ApplyMemorySettings(input_json.GetMemorySettings());
 
 		// FILL TRANSPORT CATALOGUE
 		input_json.FillCatalogue(transport_catalogue);
@@ -185,29 +271,107 @@ namespace reader{
 		// FILL MAP RENDERER
 		transport_catalogue::renderer::MapRenderer map_renderer(input_json.GetRenderSettings());
 
+		// PRECOMPUTE FREQUENT ROUTES
+		const transport_catalogue::RouteCache route_cache = BuildRouteCache(transport_router,
+				input_json.GetRouteCacheSettings());
+
 		// SAVE SERIALIZED BASE
 		const auto serialization_settings = input_json.GetSerializationSettings();
-		SaveBase(transport_catalogue, map_renderer, transport_router, serialization_settings);
+		SaveBase(transport_catalogue, map_renderer, transport_router, route_cache, serialization_settings);
+		ReportMemoryUsage(input_json.GetMemorySettings());
 	}
 
-    serialize::TransportCatalogue LoadBase(const json::Node& serialization_settings){
-        std::ifstream in(serialization_settings.AsMap().at("file"s).AsString(), std::ios::binary);
+    std::optional<serialize::TransportCatalogue> LoadBase(const json::Node& serialization_settings){
+        return LoadBaseFile(serialization_settings.AsMap().at("file"s).AsString());
+    }
+
+    std::optional<serialize::TransportCatalogue> LoadBaseFile(const std::string& file){
+        std::ifstream in(file, std::ios::binary);
         serialize::TransportCatalogue database;
-        database.ParseFromIstream(&in);
+        if (!in.is_open() || !database.ParseFromIstream(&in) || database.format_version() != tcs::BASE_FORMAT_VERSION){
+            return std::nullopt;
+        }
         return database;
     }
 
     void ProcessRequests(std::istream& in, std::ostream& out){
         reader::JsonReader input_json(json::Load(in));
-        serialize::TransportCatalogue database = LoadBase(input_json.GetSerializationSettings());
-
-        const transport_catalogue::TransportCatalogue transport_catalogue = tcs::Deserialize(database);
-        const transport_catalogue::renderer::MapRenderer map_renderer = tcs::DeserializeRenderSettings(database);
-        transport_catalogue::TransportRouter transport_router = tcs::DeserializeRouter(database);
-
-        input_json.FillRouter(transport_catalogue, transport_router);
-        transport_catalogue::RequestHandler request_handler(transport_catalogue, map_renderer, transport_router);
-        request_handler.JsonStatRequests(input_json.GetStatRequest(), out);
+        ApplyMemorySettings(input_json.GetMemorySettings());
+        const auto city_files = GetCityFiles(input_json.GetSerializationSettings());
+
+        // shards are independent, each loads its base with the router in it
+        // and publishes the result as its first snapshot; a shard whose base
+        // can not be read starts empty and answers "not found"
+        std::vector<transport_catalogue::CatalogueStore> shards(city_files.size());
+        std::vector<size_t> shard_ids(city_files.size());
+        std::iota(shard_ids.begin(), shard_ids.end(), 0);
+        std::for_each(std::execution::par, shard_ids.begin(), shard_ids.end(), [&](size_t s){
+            auto database = LoadBaseFile(city_files[s].second);
+            if (!database){
+                std::cerr << "can not load base "sv << city_files[s].second << '\n';
+            }
+            auto snapshot = std::make_unique<transport_catalogue::CatalogueSnapshot>(
+                    database.value_or(serialize::TransportCatalogue{}));
+            shards[s].Publish(std::move(snapshot));
+        });
+
+        // requests go to the shard of their "city", a single base also takes requests without one;
+        // a shard answers them in runs, each from one pinned snapshot, and a Reload request
+        // closes a run by publishing the next version of the shard
+        struct Run{
+            json::Array requests;
+            std::vector<size_t> positions;
+            std::optional<size_t> reload;
+        };
+        const json::Array& requests = input_json.GetStatRequest().AsArray();
+        std::vector<std::vector<Run>> shard_runs(shards.size(), std::vector<Run>(1));
+        std::vector<json::Node> values(requests.size());
+        for (size_t i = 0; i < requests.size(); ++i){
+            const json::Dict& request_map = requests[i].AsMap();
+            size_t s = 0;
+            if (request_map.count("city"s)){
+                const std::string& city = request_map.at("city"s).AsString();
+                s = std::find_if(city_files.begin(), city_files.end(), [&city](const auto& city_file){
+                    return city_file.first == city;
+                }) - city_files.begin();
+            }else if (shards.size() != 1){
+                s = shards.size();
+            }
+            if (s == shards.size()){
+                values[i] = json::Builder{}.StartDict().Key("request_id"s).Value(request_map.at("id"s).AsInt())
+                        .Key("error_message"s).Value("not found"s).EndDict().Build();
+                continue;
+            }
+            Run& run = shard_runs[s].back();
+            if (request_map.at("type"s).AsString() == "Reload"s){
+                run.reload = i;
+                shard_runs[s].emplace_back();
+                continue;
+            }
+            run.requests.push_back(requests[i]);
+            run.positions.push_back(i);
+        }
+
+        std::for_each(std::execution::par, shard_ids.begin(), shard_ids.end(), [&](size_t s){
+            for (const Run& run : shard_runs[s]){
+                if (!run.requests.empty()){
+                    // the pinned snapshot stays valid for the whole run even if a newer one is published
+                    const auto snapshot = shards[s].Acquire();
+                    transport_catalogue::RequestHandler request_handler(snapshot->transport_catalogue,
+                            snapshot->map_renderer, snapshot->transport_router, snapshot->route_cache);
+                    std::vector<json::Node> run_values = request_handler.JsonBuildResponses(run.requests);
+                    for (size_t k = 0; k < run_values.size(); ++k){
+                        values[run.positions[k]] = std::move(run_values[k]);
+                    }
+                }
+                if (run.reload){
+                    values[*run.reload] = ReloadShard(shards[s], requests[*run.reload].AsMap(), city_files[s].second);
+                }
+            }
+        });
+
+        transport_catalogue::RequestHandler::JsonPrintResponses(values, out);
+        ReportMemoryUsage(input_json.GetMemorySettings());
     }
 }
 
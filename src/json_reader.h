@@ -7,6 +7,9 @@
 #include "serialization.h"
 #include "request_handler.h"
 
+#include <optional>
+#include <string>
+
 namespace reader{
 
 	class JsonReader{
@@ -19,6 +22,8 @@ namespace reader{
 		const json::Node& GetRenderSettings();
 		const json::Node& GetRoutingSettings();
 		const json::Node& GetSerializationSettings();
+		const json::Node& GetRouteCacheSettings();
+		const json::Node& GetMemorySettings();
 		void FillCatalogue(transport_catalogue::TransportCatalogue& transport_catalogue);
 		void FillRouter(const transport_catalogue::TransportCatalogue& db_,
 				transport_catalogue::TransportRouter& router_);
@@ -29,8 +34,15 @@ namespace reader{
 	void SaveBase(const transport_catalogue::TransportCatalogue& transport_catalogue,
 			const transport_catalogue::renderer::MapRenderer& map_renderer,
 			const transport_catalogue::TransportRouter& transport_router,
+			const transport_catalogue::RouteCache& route_cache,
 			const json::Node& serialization_settings);
+	transport_catalogue::RouteCache BuildRouteCache(const transport_catalogue::TransportRouter& transport_router,
+			const json::Node& route_cache_settings);
+	void ApplyMemorySettings(const json::Node& memory_settings);
+	void ReportMemoryUsage(const json::Node& memory_settings);
 	void MakeBase(transport_catalogue::TransportCatalogue& transport_catalogue, std::istream& in_json);
-    serialize::TransportCatalogue LoadBase(const json::Node& serialization_settings);
+    // nullopt if the base can not be opened or parsed, or has another format version
+    std::optional<serialize::TransportCatalogue> LoadBase(const json::Node& serialization_settings);
+    std::optional<serialize::TransportCatalogue> LoadBaseFile(const std::string& file);
     void ProcessRequests(std::istream& in, std::ostream& out);
 }
@@ -142,16 +142,14 @@ namespace transport_catalogue{
             render_settings_ = render_settings;
 		}
 
-		svg::Document MapRenderer::RenderSvgDocument(const std::map<std::string, transport_catalogue::Bus*> buses) const{
-			std::map<std::string, transport_catalogue::Stop*> all_stops;
+		svg::Document MapRenderer::RenderSvgDocument(const TransportCatalogue& db, const std::vector<uint32_t>& bus_ids,
+				const std::vector<uint32_t>& stop_ids) const{
 			std::vector<geo::Coordinates> all_coordinates;
+			all_coordinates.reserve(stop_ids.size());
 			svg::Document SvgDocument;
 
-			for (const auto& [bus_name, bus_ptr] : buses){
-				for (const auto& stop : bus_ptr->stops){
-					all_stops[stop->name] = stop;
-					all_coordinates.push_back(stop->coordinates);
-				}
+			for (const uint32_t stop_id : stop_ids){
+				all_coordinates.push_back(db.GetStopCoordinates(stop_id));
 			}
 
 			SphereProjector sphere_projector(all_coordinates.begin(), all_coordinates.end(),
@@ -159,13 +157,14 @@ namespace transport_catalogue{
 
 			unsigned color_num = 0;
 
-			for (const auto& [bus_name, bus_ptr] : buses){
-				if (bus_ptr->stops.size() != 0){
+			const auto& buses = db.GetBuses();
+			for (const uint32_t bus_id : bus_ids){
+				const Bus& bus = buses[bus_id];
+				if (bus.stop_count != 0){
 					svg::Polyline polyline;
-					std::vector<geo::Coordinates> points;
 
-					for (const auto& stop : bus_ptr->stops){
-						polyline.AddPoint(sphere_projector(stop->coordinates));
+					for (size_t i = 0; i < bus.GetRouteStopCount(); ++i){
+						polyline.AddPoint(sphere_projector(db.GetStopCoordinates(db.GetRouteStopId(bus, i))));
 					}
 
 					polyline.SetFillColor("none"s);
@@ -186,12 +185,16 @@ namespace transport_catalogue{
 
 			color_num = 0;
 
-			for (const auto& [bus_name, bus_ptr] : buses){
-				if (bus_ptr->stops.size() != 0){
+			for (const uint32_t bus_id : bus_ids){
+				const Bus& bus = buses[bus_id];
+				if (bus.stop_count != 0){
+					const auto stop_ids_of_bus = db.GetBusStopIds(bus_id);
+					const uint32_t first_stop_id = *stop_ids_of_bus.begin();
+					const uint32_t last_stop_id = *(stop_ids_of_bus.end() - 1);
 
 					svg::Text text, text_underlayer;
-					text_underlayer.SetData(std::string(bus_name));
-					text.SetData(std::string(bus_name));
+					text_underlayer.SetData(std::string(bus.name));
+					text.SetData(std::string(bus.name));
 					text.SetFillColor(color_palette_[color_num]);
 
 					if (color_num < (color_palette_.size() - 1)){
@@ -208,8 +211,8 @@ namespace transport_catalogue{
 					text_underlayer.SetFontSize(bus_label_font_size_);
 					text.SetFontWeight("bold"s);
 					text_underlayer.SetFontWeight("bold"s);
-					text.SetPosition(sphere_projector(bus_ptr->stops[0]->coordinates));
-					text_underlayer.SetPosition(sphere_projector(bus_ptr->stops[0]->coordinates));
+					text.SetPosition(sphere_projector(db.GetStopCoordinates(first_stop_id)));
+					text_underlayer.SetPosition(sphere_projector(db.GetStopCoordinates(first_stop_id)));
 					text.SetOffset(bus_label_offset_);
 					text_underlayer.SetStrokeWidth(underlayer_width_);
 					text_underlayer.SetOffset(bus_label_offset_);
@@ -219,17 +222,16 @@ namespace transport_catalogue{
 					SvgDocument.Add(text_underlayer);
 					SvgDocument.Add(text);
 
-					if ((!bus_ptr->is_round && bus_ptr->stops.size() > 1
-							&& (bus_ptr->stops[0] != bus_ptr->stops[bus_ptr->stops.size() / 2]))
-							|| (bus_ptr->is_round && bus_ptr->stops[0]->name
-								!= bus_ptr->stops[bus_ptr->stops.size() - 1]->name)){
+					// stop names are unique, so equal ids mean the same stop
+					const uint32_t half_route_stop_id = db.GetRouteStopId(bus, bus.GetRouteStopCount() / 2);
+					if ((!bus.is_round && bus.stop_count > 1 && first_stop_id != half_route_stop_id)
+							|| (bus.is_round && first_stop_id != last_stop_id)){
 
 						svg::Text text_to_add = text;
 						svg::Text text_to_add_underlayer = text_underlayer;
-						size_t half_route = bus_ptr->stops.size() / 2;
 
-						text_to_add.SetPosition(sphere_projector(bus_ptr->stops[half_route]->coordinates));
-						text_to_add_underlayer.SetPosition(sphere_projector(bus_ptr->stops[half_route]->coordinates));
+						text_to_add.SetPosition(sphere_projector(db.GetStopCoordinates(half_route_stop_id)));
+						text_to_add_underlayer.SetPosition(sphere_projector(db.GetStopCoordinates(half_route_stop_id)));
 
 						SvgDocument.Add(text_to_add_underlayer);
 						SvgDocument.Add(text_to_add);
@@ -237,30 +239,30 @@ namespace transport_catalogue{
 				}
 			}
 
-			for (const auto& [stop_name, stop_ptr] : all_stops){
+			for (const uint32_t stop_id : stop_ids){
 				svg::Circle circle;
-				circle.SetCenter(sphere_projector(stop_ptr->coordinates));
+				circle.SetCenter(sphere_projector(db.GetStopCoordinates(stop_id)));
 				circle.SetRadius(stop_radius_);
 				circle.SetFillColor("white"s);
 
 				SvgDocument.Add(circle);
 			}
 
-			for (const auto& [stop_name, stop_ptr] : all_stops){
+			for (const uint32_t stop_id : stop_ids){
 				svg::Text text, text_underlayer;
 
-				text.SetPosition(sphere_projector(stop_ptr->coordinates));
+				text.SetPosition(sphere_projector(db.GetStopCoordinates(stop_id)));
 				text.SetOffset(stop_label_offset_);
 				text.SetFontSize(stop_label_font_size_);
 				text.SetFontFamily("Verdana"s);
-				text.SetData(stop_ptr->name);
+				text.SetData(std::string(db.GetStopName(stop_id)));
 				text.SetFillColor("black"s);
 
-				text_underlayer.SetPosition(sphere_projector(stop_ptr->coordinates));
+				text_underlayer.SetPosition(sphere_projector(db.GetStopCoordinates(stop_id)));
 				text_underlayer.SetOffset(stop_label_offset_);
 				text_underlayer.SetFontSize(stop_label_font_size_);
 				text_underlayer.SetFontFamily("Verdana"s);
-				text_underlayer.SetData(stop_ptr->name);
+				text_underlayer.SetData(std::string(db.GetStopName(stop_id)));
 				text_underlayer.SetFillColor(underlayer_color_);
 				text_underlayer.SetStrokeWidth(underlayer_width_);
 				text_underlayer.SetStrokeLineCap(svg::StrokeLineCap::ROUND);
@@ -1,8 +1,9 @@
 #pragma once
 #include "svg.h"
 #include "json.h"
-#include "domain.h"
+#include "transport_catalogue.h"
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
@@ -14,7 +15,10 @@ namespace transport_catalogue{
 		class MapRenderer{
 		public:
 			MapRenderer(const json::Node& render_settings);
-			svg::Document RenderSvgDocument(const std::map<std::string, transport_catalogue::Bus*> buses) const;
+			// bus and stop ids are expected in name order, stops are the ones served by the buses;
+			// coordinates and route stops are read from the flat arrays of the catalogue
+			svg::Document RenderSvgDocument(const TransportCatalogue& db, const std::vector<uint32_t>& bus_ids,
+					const std::vector<uint32_t>& stop_ids) const;
             json::Node GetRenderSettings() const;
 		private:
 			double width_;
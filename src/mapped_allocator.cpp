@@ -0,0 +1,128 @@
+#include "mapped_allocator.h"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+using namespace std::literals;
+
+namespace memory{
+
+	namespace{
+		std::atomic<AllocationMode> allocation_mode{AllocationMode::DEFAULT};
+
+		std::atomic<size_t> heap_bytes{0};
+		std::atomic<size_t> mmap_bytes{0};
+		std::atomic<size_t> transparent_huge_page_bytes{0};
+		std::atomic<size_t> huge_page_bytes{0};
+		std::atomic<size_t> huge_page_fallbacks{0};
+
+		// smaller blocks are not worth a mapping of their own
+		constexpr size_t MIN_MAPPED_BYTES = size_t{1} << 20;
+		constexpr size_t HUGE_PAGE_BYTES = size_t{2} << 20;
+
+		bool IsMapped(size_t bytes, AllocationMode mode){
+#if defined(__linux__)
+			return mode != AllocationMode::DEFAULT && bytes >= MIN_MAPPED_BYTES;
+#else
+			(void)bytes;
+			(void)mode;
+			return false;
+#endif
+		}
+
+		size_t MappingSize(size_t bytes, AllocationMode mode){
+			if (mode == AllocationMode::MMAP){
+				return bytes;
+			}
+			return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+		}
+	}
+
+	void SetAllocationMode(AllocationMode mode){
+		allocation_mode = mode;
+	}
+
+	AllocationMode GetAllocationMode(){
+		return allocation_mode;
+	}
+
+	AllocationMode ParseAllocationMode(std::string_view name){
+		if (name == "default"sv){
+			return AllocationMode::DEFAULT;
+		}else if (name == "mmap"sv){
+			return AllocationMode::MMAP;
+		}else if (name == "transparent_huge_pages"sv){
+			return AllocationMode::TRANSPARENT_HUGE_PAGES;
+		}else if (name == "huge_pages"sv){
+			return AllocationMode::HUGE_PAGES;
+		}
+		throw std::invalid_argument("unknown allocation mode: "s + std::string(name));
+	}
+
+	AllocationStats GetAllocationStats(){
+		return {heap_bytes, mmap_bytes, transparent_huge_page_bytes, huge_page_bytes, huge_page_fallbacks};
+	}
+
+	void PrintAllocationStats(std::ostream& output){
+		const AllocationStats stats = GetAllocationStats();
+		output << "routing arrays: heap "sv << stats.heap_bytes << ", mmap "sv << stats.mmap_bytes
+				<< ", transparent huge pages "sv << stats.transparent_huge_page_bytes
+				<< ", huge pages "sv << stats.huge_page_bytes << " bytes; huge page fallbacks "sv
+				<< stats.huge_page_fallbacks << '\n';
+	}
+
+	void* Allocate(size_t bytes, AllocationMode mode){
+		if (!IsMapped(bytes, mode)){
+			heap_bytes += bytes;
+			return ::operator new(bytes);
+		}
+#if defined(__linux__)
+		const size_t size = MappingSize(bytes, mode);
+		void* ptr = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+		if (mode == AllocationMode::HUGE_PAGES){
+			// fails unless huge pages are reserved by the system
+			ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (ptr != MAP_FAILED){
+				huge_page_bytes += size;
+				return ptr;
+			}
+			if (huge_page_fallbacks++ == 0){
+				std::cerr << "huge pages are not available, falling back to transparent huge pages\n"sv;
+			}
+		}
+#endif
+		ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ptr == MAP_FAILED){
+			throw std::bad_alloc();
+		}
+#if defined(MADV_HUGEPAGE)
+		if (mode != AllocationMode::MMAP && madvise(ptr, size, MADV_HUGEPAGE) == 0){
+			transparent_huge_page_bytes += size;
+			return ptr;
+		}
+#endif
+		mmap_bytes += size;
+		return ptr;
+#else
+		heap_bytes += bytes;
+		return ::operator new(bytes);
+#endif
+	}
+
+	void Deallocate(void* ptr, size_t bytes, AllocationMode mode){
+		if (!IsMapped(bytes, mode)){
+			::operator delete(ptr);
+			return;
+		}
+#if defined(__linux__)
+		munmap(ptr, MappingSize(bytes, mode));
+#endif
+	}
+}
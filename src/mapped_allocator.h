@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <string_view>
+
+namespace memory{
+
+	enum class AllocationMode{
+		DEFAULT,                 // operator new
+		MMAP,                    // anonymous mmap
+		TRANSPARENT_HUGE_PAGES,  // anonymous mmap advised with MADV_HUGEPAGE
+		HUGE_PAGES               // MAP_HUGETLB, falls back to transparent huge pages
+	};
+
+	// mode used by allocators constructed from now on
+	void SetAllocationMode(AllocationMode mode);
+	AllocationMode GetAllocationMode();
+	AllocationMode ParseAllocationMode(std::string_view name);
+
+	// bytes obtained by Allocate since the start, by how they were actually mapped
+	struct AllocationStats{
+		size_t heap_bytes = 0;
+		size_t mmap_bytes = 0;
+		size_t transparent_huge_page_bytes = 0; // advised with MADV_HUGEPAGE, the kernel may still use small pages
+		size_t huge_page_bytes = 0;             // MAP_HUGETLB
+		size_t huge_page_fallbacks = 0;         // MAP_HUGETLB failures served by the next mode down
+	};
+
+	AllocationStats GetAllocationStats();
+	void PrintAllocationStats(std::ostream& output);
+
+	void* Allocate(size_t bytes, AllocationMode mode);
+	void Deallocate(void* ptr, size_t bytes, AllocationMode mode);
+
+	// allocator for large routing arrays; remembers the mode it was created with
+	// so memory is always released the same way it was obtained
+	template <typename T>
+	class MappedAllocator{
+	public:
+		using value_type = T;
+
+		MappedAllocator()
+			: mode_(GetAllocationMode()){}
+
+		template <typename U>
+		MappedAllocator(const MappedAllocator<U>& other)
+			: mode_(other.GetMode()){}
+
+		T* allocate(size_t n){
+			return static_cast<T*>(Allocate(n * sizeof(T), mode_));
+		}
+
+		void deallocate(T* ptr, size_t n){
+			Deallocate(ptr, n * sizeof(T), mode_);
+		}
+
+		AllocationMode GetMode() const{
+			return mode_;
+		}
+
+	private:
+		AllocationMode mode_;
+	};
+
+	template <typename T, typename U>
+	bool operator==(const MappedAllocator<T>& lhs, const MappedAllocator<U>& rhs){
+		return lhs.GetMode() == rhs.GetMode();
+	}
+
+	template <typename T, typename U>
+	bool operator!=(const MappedAllocator<T>& lhs, const MappedAllocator<U>& rhs){
+		return !(lhs == rhs);
+	}
+}
@@ -0,0 +1,132 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace transport_catalogue{
+
+	namespace{
+		// a bucket whose names cannot be separated within this many seeds has colliding hashes
+		constexpr uint32_t MAX_SEED = uint32_t{1} << 24;
+	}
+
+	NameHash::NameHash(const std::vector<std::string_view>& names){
+		if (names.empty()){
+			return;
+		}
+		std::vector<uint64_t> hashes(names.size());
+		std::transform(names.begin(), names.end(), hashes.begin(), Hash);
+
+		seeds_.assign((names.size() + BUCKET_SIZE - 1) / BUCKET_SIZE, 0);
+		// equal names share a bucket, there the last one replaces the earlier ones
+		std::vector<std::vector<uint32_t>> buckets(seeds_.size());
+		std::vector<uint32_t> repeated;
+		for (uint32_t i = 0; i < names.size(); ++i){
+			std::vector<uint32_t>& bucket = buckets[hashes[i] % seeds_.size()];
+			const auto same = std::find_if(bucket.begin(), bucket.end(), [&names, i](uint32_t name){
+				return names[name] == names[i];
+			});
+			if (same != bucket.end()){
+				*same = i;
+				repeated.push_back(i);
+			}
+			else{
+				bucket.push_back(i);
+			}
+		}
+
+		// the largest buckets are placed first, while most slots are still free
+		std::vector<uint32_t> order(buckets.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t lhs, uint32_t rhs){
+			return buckets[lhs].size() > buckets[rhs].size();
+		});
+
+		values_.assign(names.size(), NO_NAME);
+		std::vector<size_t> slots;
+		for (const uint32_t bucket : order){
+			if (buckets[bucket].empty()){
+				break;
+			}
+			for (uint32_t seed = 0;; ++seed){
+				if (seed == MAX_SEED){
+					throw std::runtime_error("names can not be perfectly hashed");
+				}
+				slots.clear();
+				for (const uint32_t name : buckets[bucket]){
+					const size_t slot = Mix(hashes[name], seed) % values_.size();
+					if (values_[slot] != NO_NAME || std::find(slots.begin(), slots.end(), slot) != slots.end()){
+						break;
+					}
+					slots.push_back(slot);
+				}
+				if (slots.size() == buckets[bucket].size()){
+					seeds_[bucket] = seed;
+					for (size_t k = 0; k < slots.size(); ++k){
+						values_[slots[k]] = buckets[bucket][k];
+					}
+					break;
+				}
+			}
+		}
+		// slots left by repeated names still point to a real name
+		for (uint32_t& value : values_){
+			if (value == NO_NAME){
+				value = repeated.back();
+				repeated.pop_back();
+			}
+		}
+	}
+
+	NameHash::NameHash(std::vector<uint32_t> seeds, std::vector<uint32_t> values)
+		: seeds_(std::move(seeds))
+		, values_(std::move(values)){}
+
+	uint32_t NameHash::Find(std::string_view name) const{
+		if (values_.empty() || seeds_.empty()){
+			return NO_NAME;
+		}
+		const uint64_t hash = Hash(name);
+		return values_[Mix(hash, seeds_[hash % seeds_.size()]) % values_.size()];
+	}
+
+	bool NameHash::Covers(size_t name_count) const{
+		if (values_.size() != name_count || (!values_.empty() && seeds_.empty())){
+			return false;
+		}
+		return std::all_of(values_.begin(), values_.end(), [name_count](uint32_t value){
+			return value < name_count;
+		});
+	}
+
+	size_t NameHash::GetSize() const{
+		return values_.size();
+	}
+
+	const std::vector<uint32_t>& NameHash::GetSeeds() const{
+		return seeds_;
+	}
+
+	const std::vector<uint32_t>& NameHash::GetValues() const{
+		return values_;
+	}
+
+	uint64_t NameHash::Hash(std::string_view name){
+		// FNV-1a, stable across runs and platforms since the table is stored in the base
+		uint64_t hash = 14695981039346656037ull;
+		for (const char c : name){
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t NameHash::Mix(uint64_t hash, uint32_t seed){
+		// splitmix64 finalizer
+		uint64_t x = hash + (seed + 1) * 0x9e3779b97f4a7c15ull;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue{
+
+	// minimal perfect hash over a fixed set of names (CHD): each name gets its own slot,
+	// every bucket of names keeps the seed that placed it without collisions;
+	// any other string also lands on some slot, so callers compare the name found there
+	class NameHash{
+	public:
+		static constexpr uint32_t NO_NAME = std::numeric_limits<uint32_t>::max();
+
+		NameHash() = default;
+		// values are positions in names; a repeated name maps to its last position
+		explicit NameHash(const std::vector<std::string_view>& names);
+		NameHash(std::vector<uint32_t> seeds, std::vector<uint32_t> values);
+
+		// position of the only name that may equal the given one, NO_NAME if the set is empty
+		uint32_t Find(std::string_view name) const;
+		// whether Find only gives positions below name_count, which parts read from a base may not
+		bool Covers(size_t name_count) const;
+		size_t GetSize() const;
+		const std::vector<uint32_t>& GetSeeds() const;
+		const std::vector<uint32_t>& GetValues() const;
+
+	private:
+		// names per bucket on average, larger buckets give a smaller table but a longer build
+		static constexpr size_t BUCKET_SIZE = 4;
+
+		std::vector<uint32_t> seeds_;  // by bucket
+		std::vector<uint32_t> values_; // by slot
+
+		static uint64_t Hash(std::string_view name);
+		static uint64_t Mix(uint64_t hash, uint32_t seed);
+	};
+}
@@ -2,6 +2,9 @@
 #include "json_builder.h"
 
 #include <algorithm>
+#include <limits>
+#include <optional>
+#include <string_view>
 #include <variant>
 #include <sstream>
 #include <type_traits>
@@ -11,10 +14,12 @@ using namespace std::literals;
 namespace transport_catalogue{
 
 	RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& transport_catalogue,
-			const renderer::MapRenderer& map_renderer, transport_catalogue::TransportRouter& transport_router)
+			const renderer::MapRenderer& map_renderer, const transport_catalogue::TransportRouter& transport_router,
+			const RouteCache& route_cache)
 		: db_(transport_catalogue)
 		, renderer_(map_renderer)
 		, router_(transport_router)
+		, route_cache_(route_cache)
 		{}
 
 	json::Node RequestHandler::JsonBuildStopInfo(const json::Dict& request_map, const int& id){
@@ -25,15 +30,9 @@ namespace transport_catalogue{
 		const auto found_stop = db_.FindStop(name);
 
 		if (found_stop != nullptr){
-			std::vector<std::string> buses;
-			for (const transport_catalogue::Bus* bus : db_.GetBusesOnStop(found_stop->name)){
-				buses.push_back(bus->name);
-			}
-			std::sort(buses.begin(), buses.end());
-
 			json_builder.Key("buses").StartArray();
-			for (const std::string& bus : buses){
-				json_builder.Value(bus);
+			for (const uint32_t bus_id : db_.GetStopBusIds(found_stop->id)){
+				json_builder.Value(std::string(db_.GetBusName(bus_id)));
 			}
 			json_builder.EndArray();
 		}else{
@@ -51,14 +50,9 @@ namespace transport_catalogue{
 		const auto found_route = db_.FindRoute(name);
 
 		if (found_route != nullptr){
-			std::unordered_set<std::string> unique_stops_set;
-			for (const auto& stop : found_route->stops){
-				unique_stops_set.insert(stop->name);
-			}
-
-			json_builder.Key("curvature").Value(found_route->factual_length / found_route->length_by_coordinates);
-			json_builder.Key("stop_count").Value(static_cast<int>(found_route->stops.size()));
-			json_builder.Key("unique_stop_count").Value(static_cast<int>(unique_stops_set.size()));
+			json_builder.Key("curvature").Value(found_route->curvature);
+			json_builder.Key("stop_count").Value(static_cast<int>(found_route->stops_on_route));
+			json_builder.Key("unique_stop_count").Value(static_cast<int>(found_route->unique_stops));
 			json_builder.Key("route_length").Value(found_route->factual_length);
 		}else{
 			json_builder.Key("error_message").Value("not found"s);
@@ -79,11 +73,65 @@ namespace transport_catalogue{
 		return json_builder.EndDict().Build();
 	}
 
-	json::Node RequestHandler::JsonBuildRouteInfo(const json::Dict& request_map, const int& id){
+	json::Node RequestHandler::JsonBuildNearbyInfo(const json::Dict& request_map, const int& id){
+		json::Builder json_builder;
+		json_builder.StartDict().Key("request_id").Value(id);
+
+		// both limits are optional, a missing one does not restrict the answer
+		const geo::Coordinates point{request_map.at("latitude"s).AsDouble(), request_map.at("longitude"s).AsDouble()};
+		const size_t count = request_map.count("count"s) ? std::max(request_map.at("count"s).AsInt(), 0)
+				: std::numeric_limits<size_t>::max();
+		const double radius = request_map.count("radius"s) ? request_map.at("radius"s).AsDouble()
+				: std::numeric_limits<double>::infinity();
+
+		json_builder.Key("stops").StartArray();
+		for (const detail::NearbyStop& nearby_stop : db_.FindNearbyStops(point, count, radius)){
+			json_builder.StartDict();
+			json_builder.Key("name").Value(std::string(db_.GetStopName(nearby_stop.stop_id)));
+			json_builder.Key("distance").Value(nearby_stop.distance);
+			json_builder.EndDict();
+		}
+		json_builder.EndArray();
+
+		return json_builder.EndDict().Build();
+	}
+
+	json::Node RequestHandler::JsonBuildSuggestInfo(const json::Dict& request_map, const int& id){
+		json::Builder json_builder;
+		json_builder.StartDict().Key("request_id").Value(id);
+
+		// completions go in name order, a missing count does not restrict the answer
+		const std::string& prefix = request_map.at("prefix"s).AsString();
+		const size_t count = request_map.count("count"s) ? std::max(request_map.at("count"s).AsInt(), 0)
+				: std::numeric_limits<size_t>::max();
+
+		json_builder.Key("stops").StartArray();
+		size_t added = 0;
+		for (const uint32_t stop_id : db_.FindStopsByPrefix(prefix)){
+			if (added++ == count){
+				break;
+			}
+			json_builder.Value(std::string(db_.GetStopName(stop_id)));
+		}
+		json_builder.EndArray();
+
+		json_builder.Key("buses").StartArray();
+		added = 0;
+		for (const uint32_t bus_id : db_.FindBusesByPrefix(prefix)){
+			if (added++ == count){
+				break;
+			}
+			json_builder.Value(std::string(db_.GetBusName(bus_id)));
+		}
+		json_builder.EndArray();
+
+		return json_builder.EndDict().Build();
+	}
+
+	json::Node RequestHandler::JsonBuildRouteInfo(const std::optional<detail::RouteInfo>& route_info, const int& id){
 		json::Builder json_builder;
 		json_builder.StartDict().Key("request_id").Value(id);
 
-		const auto route_info = router_.GetRouteInfo(request_map.at("from").AsString(), request_map.at("to").AsString());
 		if (route_info.has_value()){
 			json_builder.Key("items").StartArray();
 			for (const auto& elem : route_info.value().items_){
@@ -91,14 +139,21 @@ namespace transport_catalogue{
 				if (std::holds_alternative<detail::RouteItemWait>(elem.item)){
 					const auto route_item_wait = std::get<detail::RouteItemWait>(elem.item);
 					json_builder.Key("type").Value("Wait"s);
-					json_builder.Key("time").Value(route_item_wait.stop_name);
+					json_builder.Key("time").Value(std::string(route_item_wait.stop_name));
 					json_builder.Key("stop_name").Value(route_item_wait.time.count());
 				}else if (std::holds_alternative<detail::RouteItemBus>(elem.item)){
 					const auto route_item_bus = std::get<detail::RouteItemBus>(elem.item);
 					json_builder.Key("type").Value("Bus"s);
 					json_builder.Key("time").Value(route_item_bus.time.count());
 					json_builder.Key("span_count").Value(route_item_bus.span_count);
-					json_builder.Key("bus").Value(route_item_bus.bus_name);
+					json_builder.Key("bus").Value(std::string(route_item_bus.bus_name));
+				}else if (std::holds_alternative<detail::RouteItemWalk>(elem.item)){
+					const auto route_item_walk = std::get<detail::RouteItemWalk>(elem.item);
+					json_builder.Key("type").Value("Walk"s);
+					if (!route_item_walk.stop_name.empty()){
+						json_builder.Key("stop_name").Value(std::string(route_item_walk.stop_name));
+					}
+					json_builder.Key("time").Value(route_item_walk.time.count());
 				}
 				json_builder.EndDict();
 			}
@@ -111,28 +166,95 @@ namespace transport_catalogue{
 		return json_builder.EndDict().Build();
 	}
 
+	json::Node RequestHandler::JsonBuildRouteInfo(const json::Dict& request_map, const int& id){
+		if (!request_map.at("from"s).IsString() || !request_map.at("to"s).IsString()){
+			return JsonBuildPointRouteInfo(request_map, id);
+		}
+		// precomputed routes are served from the cache
+		const std::string& from = request_map.at("from"s).AsString();
+		const std::string& to = request_map.at("to"s).AsString();
+		if (const auto cached_route = route_cache_.Find(from, to); cached_route != nullptr){
+			return JsonBuildRouteInfo(cached_route->route_info, id);
+		}
+		return JsonBuildRouteInfo(router_.GetRouteInfo(from, to), id);
+	}
+
+	json::Node RequestHandler::JsonBuildPointRouteInfo(const json::Dict& request_map, const int& id){
+		geo::Coordinates from, to;
+		std::vector<detail::StopAccess> stops_from, stops_to;
+		if (!SnapEndpoint(request_map.at("from"s), from, stops_from) || !SnapEndpoint(request_map.at("to"s), to, stops_to)){
+			return JsonBuildRouteInfo(std::nullopt, id);
+		}
+
+		// the batch kernel clamps rounding, so equal points give 0 instead of nan
+		const geo::SpherePoint points[] = {geo::ToSpherePoint(from), geo::ToSpherePoint(to)};
+		double distance = 0.0;
+		geo::ComputePathDistances(points, 2, &distance);
+		std::optional<double> direct_walk_time;
+		if (distance <= TransportRouter::MAX_WALK_DISTANCE){
+			direct_walk_time = router_.GetWalkTime(distance);
+		}
+
+		return JsonBuildRouteInfo(router_.GetRouteInfo(stops_from, stops_to, direct_walk_time), id);
+	}
+
+	// an endpoint is a stop name or a point {"latitude", "longitude"} snapped to its nearest stops
+	// within walking distance; a point with none of them is still reached by a direct walk
+	bool RequestHandler::SnapEndpoint(const json::Node& endpoint, geo::Coordinates& point,
+			std::vector<detail::StopAccess>& stops) const{
+		if (endpoint.IsString()){
+			const Stop* stop = db_.FindStop(endpoint.AsString());
+			if (stop == nullptr){
+				return false;
+			}
+			point = db_.GetStopCoordinates(stop->id);
+			stops.push_back({stop->name, 0.0});
+			return true;
+		}
+
+		const json::Dict& point_map = endpoint.AsMap();
+		point = {point_map.at("latitude"s).AsDouble(), point_map.at("longitude"s).AsDouble()};
+		for (const detail::NearbyStop& nearby_stop : db_.FindNearbyStops(point, TransportRouter::SNAP_STOP_COUNT,
+				TransportRouter::MAX_WALK_DISTANCE)){
+			stops.push_back({db_.GetStopName(nearby_stop.stop_id), router_.GetWalkTime(nearby_stop.distance)});
+		}
+		return true;
+	}
+
 	void RequestHandler::JsonStatRequests(const json::Node& json_input, std::ostream& output){
-		const json::Array& arr = json_input.AsArray();
+		JsonPrintResponses(JsonBuildResponses(json_input.AsArray()), output);
+	}
 
-		json::Builder json_builder;
-		json_builder.StartArray();
+	std::vector<json::Node> RequestHandler::JsonBuildResponses(const json::Array& arr){
+		std::vector<json::Node> values(arr.size());
 
-		for (const auto& request_node : arr){
-			const json::Dict& request_map = request_node.AsMap();
+		for (size_t i = 0; i < arr.size(); ++i){
+			const json::Dict& request_map = arr[i].AsMap();
 			const int id = request_map.at("id"s).AsInt();
 			const std::string& type = request_map.at("type"s).AsString();
-			json::Node value;
 
 			if (type == "Stop"sv){
-				value = JsonBuildStopInfo(request_map, id);
+				values[i] = JsonBuildStopInfo(request_map, id);
 			}else if(type == "Bus"sv){
-				value = JsonBuildBusInfo(request_map, id);
+				values[i] = JsonBuildBusInfo(request_map, id);
+			}else if(type == "Route"sv){
+				values[i] = JsonBuildRouteInfo(request_map, id);
 			}else if(type == "Map"sv){
-				value = JsonBuildMapInfo(id);
-			}else if (type == "Route"sv){
-				value = JsonBuildRouteInfo(request_map, id);
+				values[i] = JsonBuildMapInfo(id);
+			}else if(type == "Nearby"sv){
+				values[i] = JsonBuildNearbyInfo(request_map, id);
+			}else if(type == "Suggest"sv){
+				values[i] = JsonBuildSuggestInfo(request_map, id);
 			}
+		}
+
+		return values;
+	}
 
+	void RequestHandler::JsonPrintResponses(const std::vector<json::Node>& values, std::ostream& output){
+		json::Builder json_builder;
+		json_builder.StartArray();
+		for (const json::Node& value : values){
 			json_builder.Value(value.AsMap());
 		}
 
@@ -140,6 +262,16 @@ namespace transport_catalogue{
 	}
 
 	svg::Document RequestHandler::RenderMap() const{
-		return renderer_.RenderSvgDocument(db_.GetSortedBuses());
+		const auto bus_ids = db_.GetSortedBusIds();
+
+		std::vector<uint32_t> stop_ids;
+		for (const uint32_t stop_id : db_.GetSortedStopIds()){
+			const auto stop_buses = db_.GetStopBusIds(stop_id);
+			if (stop_buses.begin() != stop_buses.end()){
+				stop_ids.push_back(stop_id);
+			}
+		}
+
+		return renderer_.RenderSvgDocument(db_, {bus_ids.begin(), bus_ids.end()}, stop_ids);
 	}
 }
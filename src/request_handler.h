@@ -4,25 +4,36 @@
 #include "json.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "route_cache.h"
 
 namespace transport_catalogue{
 
 	class RequestHandler{
 	public:
 		RequestHandler(const transport_catalogue::TransportCatalogue& transport_catalogue,
-				const renderer::MapRenderer& map_renderer, transport_catalogue::TransportRouter& transport_router);
+				const renderer::MapRenderer& map_renderer, const transport_catalogue::TransportRouter& transport_router,
+				const RouteCache& route_cache);
 
 		void JsonStatRequests(const json::Node& json_document, std::ostream& output);
+		// answers in request order
+		std::vector<json::Node> JsonBuildResponses(const json::Array& requests);
+		static void JsonPrintResponses(const std::vector<json::Node>& values, std::ostream& output);
 
 	private:
 		json::Node JsonBuildStopInfo(const json::Dict& request_map, const int& id);
 		json::Node JsonBuildBusInfo(const json::Dict& request_map, const int& id);
 		json::Node JsonBuildMapInfo(const int& id);
+		json::Node JsonBuildNearbyInfo(const json::Dict& request_map, const int& id);
+		json::Node JsonBuildSuggestInfo(const json::Dict& request_map, const int& id);
 		json::Node JsonBuildRouteInfo(const json::Dict& request_map, const int& id);
+		json::Node JsonBuildRouteInfo(const std::optional<detail::RouteInfo>& route_info, const int& id);
+		json::Node JsonBuildPointRouteInfo(const json::Dict& request_map, const int& id);
+		bool SnapEndpoint(const json::Node& endpoint, geo::Coordinates& point, std::vector<detail::StopAccess>& stops) const;
 		svg::Document RenderMap() const;
 
 		const transport_catalogue::TransportCatalogue& db_;
 		const renderer::MapRenderer& renderer_;
-        transport_catalogue::TransportRouter& router_;
+        const transport_catalogue::TransportRouter& router_;
+		const RouteCache& route_cache_;
 	};
 }
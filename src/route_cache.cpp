@@ -0,0 +1,118 @@
+#include "route_cache.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace std::literals;
+
+namespace transport_catalogue{
+
+	uint64_t RouteCache::Hash(std::string_view from, std::string_view to){
+		// FNV-1a, stable between make_base and process_requests runs
+		uint64_t hash = 14695981039346656037ull;
+		const auto mix = [&hash](std::string_view s){
+			for (const char c : s){
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 1099511628211ull;
+			}
+		};
+		mix(from);
+		hash ^= 0xff;
+		hash *= 1099511628211ull;
+		mix(to);
+		return hash;
+	}
+
+	void RouteCache::Build(const std::vector<std::pair<std::string, std::string>>& routes,
+			const TransportRouter& router){
+		entries_.clear();
+		entries_.reserve(routes.size());
+
+		size_t slot_count = 1;
+		while (slot_count < routes.size() * 2){
+			slot_count *= 2;
+		}
+		slots_.assign(slot_count, 0);
+
+		for (const auto& [from, to] : routes){
+			if (Find(from, to) != nullptr){
+				continue;
+			}
+			entries_.push_back({GetNamePool().Intern(from), GetNamePool().Intern(to), router.GetRouteInfo(from, to)});
+
+			size_t slot = Hash(from, to) & (slots_.size() - 1);
+			while (slots_[slot] != 0){
+				slot = (slot + 1) & (slots_.size() - 1);
+			}
+			slots_[slot] = static_cast<uint32_t>(entries_.size());
+		}
+	}
+
+	const detail::CachedRoute* RouteCache::Find(std::string_view from, std::string_view to) const{
+		if (entries_.empty()){
+			return nullptr;
+		}
+		for (size_t slot = Hash(from, to) & (slots_.size() - 1); slots_[slot] != 0;
+				slot = (slot + 1) & (slots_.size() - 1)){
+			const detail::CachedRoute& entry = entries_[slots_[slot] - 1];
+			if (entry.from == from && entry.to == to){
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	void RouteCache::SetEntries(std::vector<detail::CachedRoute> entries, std::vector<uint32_t> slots){
+		// Find needs a power of two table with a free slot to stop at and ids of real entries
+		const bool fits = entries.size() < slots.size() && (slots.size() & (slots.size() - 1)) == 0
+				&& std::all_of(slots.begin(), slots.end(), [&entries](uint32_t slot){
+					return slot <= entries.size();
+				})
+				&& std::count(slots.begin(), slots.end(), 0u) == static_cast<std::ptrdiff_t>(slots.size() - entries.size());
+		if (!fits){
+			entries_.clear();
+			slots_.clear();
+			return;
+		}
+		entries_ = std::move(entries);
+		slots_ = std::move(slots);
+	}
+
+	const std::vector<detail::CachedRoute>& RouteCache::GetEntries() const{
+		return entries_;
+	}
+
+	const std::vector<uint32_t>& RouteCache::GetSlots() const{
+		return slots_;
+	}
+
+	std::vector<std::pair<std::string, std::string>> MostFrequentRoutes(const json::Node& stat_requests,
+			size_t max_routes){
+		std::map<std::pair<std::string, std::string>, size_t> route_counts;
+		for (const auto& request_node : stat_requests.AsArray()){
+			const json::Dict& request_map = request_node.AsMap();
+			// only routes between stop names can be cached
+			if (request_map.at("type"s).AsString() == "Route"sv && request_map.at("from"s).IsString()
+					&& request_map.at("to"s).IsString()){
+				++route_counts[{request_map.at("from"s).AsString(), request_map.at("to"s).AsString()}];
+			}
+		}
+
+		std::vector<std::pair<size_t, const std::pair<std::string, std::string>*>> by_count;
+		by_count.reserve(route_counts.size());
+		for (const auto& [route, count] : route_counts){
+			by_count.emplace_back(count, &route);
+		}
+		// most frequent first, ties keep name order so bases are reproducible
+		std::stable_sort(by_count.begin(), by_count.end(), [](const auto& lhs, const auto& rhs){
+			return lhs.first > rhs.first;
+		});
+
+		std::vector<std::pair<std::string, std::string>> result;
+		result.reserve(std::min(max_routes, by_count.size()));
+		for (size_t i = 0; i < by_count.size() && i < max_routes; ++i){
+			result.push_back(*by_count[i].second);
+		}
+		return result;
+	}
+}
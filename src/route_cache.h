@@ -0,0 +1,42 @@
+#pragma once
+#include "transport_router.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue{
+
+	namespace detail{
+		// stop names are views into GetNamePool()
+		struct CachedRoute{
+			std::string_view from;
+			std::string_view to;
+			std::optional<RouteInfo> route_info;
+		};
+	}
+
+	// precomputed answers for frequent (from, to) route requests,
+	// indexed by an open addressing table of 1-based entry ids
+	class RouteCache{
+	public:
+		void Build(const std::vector<std::pair<std::string, std::string>>& routes, const TransportRouter& router);
+		const detail::CachedRoute* Find(std::string_view from, std::string_view to) const;
+		// entries and slots read from a base; a table that does not fit the entries leaves the cache empty
+		void SetEntries(std::vector<detail::CachedRoute> entries, std::vector<uint32_t> slots);
+		const std::vector<detail::CachedRoute>& GetEntries() const;
+		const std::vector<uint32_t>& GetSlots() const;
+
+	private:
+		std::vector<detail::CachedRoute> entries_;
+		std::vector<uint32_t> slots_;
+
+		static uint64_t Hash(std::string_view from, std::string_view to);
+	};
+
+	std::vector<std::pair<std::string, std::string>> MostFrequentRoutes(const json::Node& stat_requests,
+			size_t max_routes);
+}
@@ -1,113 +1,298 @@
 #pragma once
 
 #include "graph.h"
+#include "mapped_allocator.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
-#include <unordered_map>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace graph{
 
+	// vertex count of a router whose tables are sized at runtime
+	inline constexpr size_t DYNAMIC_VERTEX_COUNT = 0;
+
 	template <typename Weight>
+	struct RouteInfo {
+		Weight weight;
+		std::vector<EdgeId> edges;
+	};
+
+	namespace detail {
+		// square route tables; row length is the terminal count
+		template <typename Weight, typename PrevEdgeIndex, size_t MaxVertices>
+		class RouteTables {
+		public:
+			RouteTables(size_t vertex_count, Weight weight, PrevEdgeIndex prev_edge)
+				: weights_(CheckedSize(vertex_count) * vertex_count, weight)
+				, prev_edges_(vertex_count * vertex_count, prev_edge)
+				, row_length_(vertex_count) {
+			}
+
+			size_t RowLength() const {
+				return row_length_;
+			}
+			Weight* Weights() {
+				return weights_.data();
+			}
+			const Weight* Weights() const {
+				return weights_.data();
+			}
+			PrevEdgeIndex* PrevEdges() {
+				return prev_edges_.data();
+			}
+			const PrevEdgeIndex* PrevEdges() const {
+				return prev_edges_.data();
+			}
+
+		private:
+			std::vector<Weight, memory::MappedAllocator<Weight>> weights_;
+			std::vector<PrevEdgeIndex, memory::MappedAllocator<PrevEdgeIndex>> prev_edges_;
+			size_t row_length_;
+
+			static size_t CheckedSize(size_t vertex_count) {
+				if (MaxVertices != DYNAMIC_VERTEX_COUNT && vertex_count > MaxVertices) {
+					throw std::length_error("Graph does not fit into fixed size router");
+				}
+				return vertex_count;
+			}
+		};
+	}
+
+	// MaxVertices bounds the number of terminal vertices at compile time, up to 255 of them
+	// need only 8-bit predecessor indices; tables are sized by the real terminal count either way
+	template <typename Weight, size_t MaxVertices = DYNAMIC_VERTEX_COUNT>
 	class Router {
 	private:
 		using Graph = DirectedWeightedGraph<Weight>;
 
 	public:
 		explicit Router(const Graph& graph);
+		// keeps answers only for routes between terminal vertices,
+		// the rest of the vertices are used as intermediates
+		Router(const Graph& graph, const std::vector<VertexId>& terminals);
 
-		struct RouteInfo {
-			Weight weight;
-			std::vector<EdgeId> edges;
-		};
+		using RouteInfo = graph::RouteInfo<Weight>;
 
 		std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+		// weight of the route without unpacking its edges
+		std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
 
 	private:
-		struct RouteInternalData {
-			Weight weight;
-			std::optional<EdgeId> prev_edge;
-		};
-		using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+		// predecessor shortcut of a route, stored as 1-based index into the incoming
+		// shortcut list of the route's last terminal; 0 means the route has no edges
+		using PrevEdgeIndex = std::conditional_t<MaxVertices != DYNAMIC_VERTEX_COUNT
+				&& MaxVertices <= std::numeric_limits<std::uint8_t>::max(), std::uint8_t, std::uint16_t>;
+		using RouteTables = detail::RouteTables<Weight, PrevEdgeIndex, MaxVertices>;
+		static constexpr PrevEdgeIndex NO_PREV_EDGE = 0;
+		static constexpr size_t NO_TERMINAL = std::numeric_limits<size_t>::max();
 
-		void InitializeRoutesInternalData(const Graph& graph) {
-			const size_t vertex_count = graph.GetVertexCount();
-			for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-				routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+		size_t Cell(size_t terminal_from, size_t terminal_to) const {
+			return terminal_from * tables_.RowLength() + terminal_to;
+		}
+
+		void InitializeTerminals(const std::vector<VertexId>& terminals) {
+			for (size_t terminal = 0; terminal < terminals.size(); ++terminal) {
+				terminal_ids_.at(terminals[terminal]) = terminal;
+			}
+		}
+
+		// shortest paths from the source to the terminals it reaches through non-terminal vertices only
+		void SearchShortcuts(const Graph& graph, VertexId source, std::vector<Weight>& distances,
+							 std::vector<EdgeId>& prev_edges, std::vector<VertexId>& reached) const {
+			using QueueItem = std::pair<Weight, VertexId>;
+			std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+			distances[source] = ZERO_WEIGHT;
+			reached.push_back(source);
+			queue.push({ZERO_WEIGHT, source});
+			while (!queue.empty()) {
+				const auto [distance, vertex] = queue.top();
+				queue.pop();
+				if (distances[vertex] < distance || (vertex != source && terminal_ids_[vertex] != NO_TERMINAL)) {
+					continue;
+				}
 				for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
 					const auto& edge = graph.GetEdge(edge_id);
 					if (edge.weight < ZERO_WEIGHT) {
 						throw std::domain_error("Edges' weights should be non-negative");
 					}
-					auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-					if (!route_internal_data || route_internal_data->weight > edge.weight) {
-						route_internal_data = RouteInternalData{edge.weight, edge_id};
+					const Weight candidate_weight = distance + edge.weight;
+					if (candidate_weight < distances[edge.to]) {
+						if (distances[edge.to] == UNREACHABLE) {
+							reached.push_back(edge.to);
+						}
+						distances[edge.to] = candidate_weight;
+						prev_edges[edge.to] = edge_id;
+						queue.push({candidate_weight, edge.to});
 					}
 				}
 			}
 		}
 
-		void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-						const RouteInternalData& route_to) {
-			auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-			const Weight candidate_weight = route_from.weight + route_to.weight;
-			if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-				route_relaxing = {candidate_weight,
-								  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+		void InitializeRoutesInternalData(const Graph& graph) {
+			Weight* weights = tables_.Weights();
+			PrevEdgeIndex* prev_edges_table = tables_.PrevEdges();
+			std::vector<Weight> distances(graph.GetVertexCount(), UNREACHABLE);
+			std::vector<EdgeId> prev_edges(graph.GetVertexCount());
+			std::vector<VertexId> reached;
+			std::vector<EdgeId> path;
+			shortcut_offsets_.push_back(0);
+
+			for (size_t terminal_from = 0; terminal_from < terminal_count_; ++terminal_from) {
+				weights[Cell(terminal_from, terminal_from)] = ZERO_WEIGHT;
+				const VertexId source = terminals_[terminal_from];
+				SearchShortcuts(graph, source, distances, prev_edges, reached);
+
+				for (const VertexId vertex : reached) {
+					const size_t terminal_to = terminal_ids_[vertex];
+					if (vertex == source || terminal_to == NO_TERMINAL) {
+						continue;
+					}
+					auto& incoming_shortcuts = incoming_shortcuts_[terminal_to];
+					if (incoming_shortcuts.size() >= std::numeric_limits<PrevEdgeIndex>::max()) {
+						throw std::length_error("Too many incoming edges for compact route storage");
+					}
+
+					path.clear();
+					for (VertexId path_vertex = vertex; path_vertex != source;
+						 path_vertex = graph.GetEdge(prev_edges[path_vertex]).from) {
+						path.push_back(prev_edges[path_vertex]);
+					}
+					shortcut_edges_.insert(shortcut_edges_.end(), path.rbegin(), path.rend());
+					shortcut_offsets_.push_back(shortcut_edges_.size());
+
+					incoming_shortcuts.push_back(shortcut_offsets_.size() - 2);
+					weights[Cell(terminal_from, terminal_to)] = distances[vertex];
+					prev_edges_table[Cell(terminal_from, terminal_to)] = static_cast<PrevEdgeIndex>(incoming_shortcuts.size());
+				}
+
+				for (const VertexId vertex : reached) {
+					distances[vertex] = UNREACHABLE;
+				}
+				reached.clear();
 			}
 		}
 
-		void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-			for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-				if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-					for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-						if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-							RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-						}
+		void RelaxRoutesInternalDataThroughVertex(size_t terminal_through) {
+			Weight* weights = tables_.Weights();
+			PrevEdgeIndex* prev_edges = tables_.PrevEdges();
+			const Weight* weights_through = &weights[Cell(terminal_through, 0)];
+			const PrevEdgeIndex* prev_edges_through = &prev_edges[Cell(terminal_through, 0)];
+			for (size_t terminal_from = 0; terminal_from < terminal_count_; ++terminal_from) {
+				const Weight weight_from = weights[Cell(terminal_from, terminal_through)];
+				if (weight_from == UNREACHABLE) {
+					continue;
+				}
+				const PrevEdgeIndex prev_edge_from = prev_edges[Cell(terminal_from, terminal_through)];
+				Weight* weights_relaxing = &weights[Cell(terminal_from, 0)];
+				PrevEdgeIndex* prev_edges_relaxing = &prev_edges[Cell(terminal_from, 0)];
+				for (size_t terminal_to = 0; terminal_to < terminal_count_; ++terminal_to) {
+					if (weights_through[terminal_to] == UNREACHABLE) {
+						continue;
+					}
+					const Weight candidate_weight = weight_from + weights_through[terminal_to];
+					if (candidate_weight < weights_relaxing[terminal_to]) {
+						weights_relaxing[terminal_to] = candidate_weight;
+						// through == to is the only zero-edge route, its last edge comes from the first half
+						prev_edges_relaxing[terminal_to] = prev_edges_through[terminal_to] != NO_PREV_EDGE
+								? prev_edges_through[terminal_to] : prev_edge_from;
 					}
 				}
 			}
 		}
 
+		void ComputeRoutes(const Graph& graph) {
+			InitializeRoutesInternalData(graph);
+			for (size_t terminal_through = 0; terminal_through < terminal_count_; ++terminal_through) {
+				RelaxRoutesInternalDataThroughVertex(terminal_through);
+			}
+		}
+
+		static std::vector<VertexId> AllVertices(const Graph& graph) {
+			std::vector<VertexId> vertices(graph.GetVertexCount());
+			for (VertexId vertex = 0; vertex < vertices.size(); ++vertex) {
+				vertices[vertex] = vertex;
+			}
+			return vertices;
+		}
+
 		static constexpr Weight ZERO_WEIGHT{};
+		static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::max();
 		const Graph& graph_;
-		RoutesInternalData routes_internal_data_;
+		std::vector<VertexId> terminals_;
+		std::vector<size_t> terminal_ids_;
+		size_t terminal_count_;
+		RouteTables tables_;
+		// edges of shortcut i are shortcut_edges_[shortcut_offsets_[i], shortcut_offsets_[i + 1])
+		std::vector<EdgeId> shortcut_edges_;
+		std::vector<size_t> shortcut_offsets_;
+		std::vector<std::vector<size_t>> incoming_shortcuts_;
 	};
 
-	template <typename Weight>
-	Router<Weight>::Router(const Graph& graph)
+	template <typename Weight, size_t MaxVertices>
+	Router<Weight, MaxVertices>::Router(const Graph& graph)
+		: Router(graph, AllVertices(graph))
+	{
+	}
+
+	template <typename Weight, size_t MaxVertices>
+	Router<Weight, MaxVertices>::Router(const Graph& graph, const std::vector<VertexId>& terminals)
 		: graph_(graph)
-		, routes_internal_data_(graph.GetVertexCount(),
-								std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+		, terminals_(terminals)
+		, terminal_ids_(graph.GetVertexCount(), NO_TERMINAL)
+		, terminal_count_(terminals.size())
+		, tables_(terminal_count_, UNREACHABLE, NO_PREV_EDGE)
+		, incoming_shortcuts_(terminal_count_)
 	{
-		InitializeRoutesInternalData(graph);
+		InitializeTerminals(terminals);
+		ComputeRoutes(graph);
+	}
 
-		const size_t vertex_count = graph.GetVertexCount();
-		for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-			RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+	template <typename Weight, size_t MaxVertices>
+	std::optional<Weight> Router<Weight, MaxVertices>::GetRouteWeight(VertexId from, VertexId to) const {
+		const size_t terminal_from = terminal_ids_.at(from);
+		const size_t terminal_to = terminal_ids_.at(to);
+		if (terminal_from == NO_TERMINAL || terminal_to == NO_TERMINAL) {
+			throw std::out_of_range("Routes are kept only between terminal vertices");
+		}
+		const Weight weight = tables_.Weights()[Cell(terminal_from, terminal_to)];
+		if (weight == UNREACHABLE) {
+			return std::nullopt;
 		}
+		return weight;
 	}
 
-	template <typename Weight>
-	std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-																				 VertexId to) const {
-		const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-		if (!route_internal_data) {
+	template <typename Weight, size_t MaxVertices>
+	std::optional<typename Router<Weight, MaxVertices>::RouteInfo> Router<Weight, MaxVertices>::BuildRoute(
+			VertexId from, VertexId to) const {
+		const size_t terminal_from = terminal_ids_.at(from);
+		const size_t terminal_to = terminal_ids_.at(to);
+		if (terminal_from == NO_TERMINAL || terminal_to == NO_TERMINAL) {
+			throw std::out_of_range("Routes are kept only between terminal vertices");
+		}
+		const Weight* weights = tables_.Weights();
+		const PrevEdgeIndex* prev_edges = tables_.PrevEdges();
+		const Weight weight = weights[Cell(terminal_from, terminal_to)];
+		if (weight == UNREACHABLE) {
 			return std::nullopt;
 		}
-		const Weight weight = route_internal_data->weight;
 		std::vector<EdgeId> edges;
-		for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-			 edge_id;
-			 edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-		{
-			edges.push_back(*edge_id);
+		for (size_t terminal = terminal_to; prev_edges[Cell(terminal_from, terminal)] != NO_PREV_EDGE;) {
+			const size_t shortcut = incoming_shortcuts_[terminal][prev_edges[Cell(terminal_from, terminal)] - 1];
+			const size_t shortcut_begin = shortcut_offsets_[shortcut];
+			for (size_t i = shortcut_offsets_[shortcut + 1]; i > shortcut_begin; --i) {
+				edges.push_back(shortcut_edges_[i - 1]);
+			}
+			terminal = terminal_ids_[graph_.GetEdge(shortcut_edges_[shortcut_begin]).from];
 		}
 		std::reverse(edges.begin(), edges.end());
 
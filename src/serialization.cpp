@@ -7,31 +7,35 @@ namespace tcs{
 
     serialize::Stop SerializeStop(const transport_catalogue::Stop* stop){
         serialize::Stop result;
-        result.set_name(stop->name);
+        result.set_name(stop->name.data(), stop->name.size());
         result.add_coordinates(stop->coordinates.lat);
         result.add_coordinates(stop->coordinates.lng);
 
         return result;
     }
 
-    serialize::Bus SerializeBus(const transport_catalogue::Bus* bus){
+    serialize::Bus SerializeBus(const transport_catalogue::Bus* bus,
+            transport_catalogue::TransportCatalogue::IdRange stop_ids){
         serialize::Bus result;
-        result.set_name(bus->name);
-        for (const auto& stop : bus->stops){
-            result.add_stop(stop->name);
-        }
+        result.set_name(bus->name.data(), bus->name.size());
+        // stops are stored in id order, so ids stay valid after loading
+        *result.mutable_stop_id() = {stop_ids.begin(), stop_ids.end()};
 
         result.set_is_round(bus->is_round);
+        result.set_route_length(bus->factual_length);
+        result.set_geo_length(bus->length_by_coordinates);
+        result.set_curvature(bus->curvature);
+        result.set_stop_count(bus->stops_on_route);
+        result.set_unique_stop_count(bus->unique_stops);
         return result;
     }
 
-    serialize::DistanceBetweenStops SerializeDistance(const std::pair<
-            const std::pair<transport_catalogue::Stop*, transport_catalogue::Stop*>, int>&
-            distance_pair){
+    serialize::DistanceBetweenStops SerializeDistance(const transport_catalogue::Stop& from,
+            const transport_catalogue::Stop& to, int distance){
         serialize::DistanceBetweenStops result;
-        result.set_from_stop(distance_pair.first.first->name);
-        result.set_to_stop(distance_pair.first.second->name);
-        result.set_distance(distance_pair.second);
+        result.set_from_stop_id(from.id);
+        result.set_to_stop_id(to.id);
+        result.set_distance(distance);
 
         return result;
     }
@@ -96,6 +100,7 @@ namespace tcs{
         serialize::RouterSettings result;
         result.set_bus_wait_time(routing_settings.bus_wait_time_);
         result.set_bus_velocity(routing_settings.bus_velocity_);
+        result.set_pedestrian_velocity(routing_settings.pedestrian_velocity_);
 
         return result;
     }
@@ -129,16 +134,16 @@ namespace tcs{
 
     serialize::EdgeInfo SerializeEdgeInfo(const transport_catalogue::detail::EdgeInfo& edge_info){
         serialize::EdgeInfo result;
-        result.set_name(edge_info.name);
-        *result.mutable_edge() = SerializeEdge(edge_info.edge);
+        result.set_name_id(edge_info.name_id);
         result.set_span_count(edge_info.span_count);
-        result.set_time(std::chrono::duration<double>(edge_info.time).count());
 
         return result;
     }
 
-    serialize::Vertexes SerializeVertexes(const transport_catalogue::detail::Vertexes& vertexes){
+    serialize::Vertexes SerializeVertexes(std::string_view stop_name,
+            const transport_catalogue::detail::Vertexes& vertexes){
         serialize::Vertexes result;
+        result.set_name(stop_name.data(), stop_name.size());
         result.set_start_wait(vertexes.start_wait);
         result.set_end_wait(vertexes.end_wait);
 
@@ -152,8 +157,56 @@ namespace tcs{
         for (const auto& edge : router.GetEdges()){
             *result.add_edges() =  SerializeEdgeInfo(edge);
         }
+        for (const auto& name : router.GetNames()){
+            result.add_name(name.data(), name.size());
+        }
         for(const auto& [name, vertexes] : router.GetStopToVertexId()){
-            *result.add_vertexes() = SerializeVertexes(vertexes);
+            *result.add_vertexes() = SerializeVertexes(name, vertexes);
+        }
+
+        return result;
+    }
+
+    serialize::NameHash SerializeNameHash(const transport_catalogue::NameHash& name_hash){
+        serialize::NameHash result;
+        *result.mutable_seed() = {name_hash.GetSeeds().begin(), name_hash.GetSeeds().end()};
+        *result.mutable_value() = {name_hash.GetValues().begin(), name_hash.GetValues().end()};
+        return result;
+    }
+
+    serialize::RouteCache SerializeRouteCache(const transport_catalogue::RouteCache& route_cache){
+        serialize::RouteCache result;
+        for (const uint32_t slot : route_cache.GetSlots()){
+            result.add_slot(slot);
+        }
+        for (const auto& entry : route_cache.GetEntries()){
+            serialize::CachedRoute& route = *result.add_route();
+            route.set_from(entry.from.data(), entry.from.size());
+            route.set_to(entry.to.data(), entry.to.size());
+            route.set_found(entry.route_info.has_value());
+            if (!entry.route_info){
+                continue;
+            }
+            route.set_total_time(entry.route_info->total_time);
+            for (const auto& elem : entry.route_info->items_){
+                serialize::RouteItem& item = *route.add_item();
+                if (std::holds_alternative<transport_catalogue::detail::RouteItemWait>(elem.item)){
+                    const auto& item_wait = std::get<transport_catalogue::detail::RouteItemWait>(elem.item);
+                    item.set_name(item_wait.stop_name.data(), item_wait.stop_name.size());
+                    item.set_span_count(-1);
+                    item.set_time(item_wait.time.count());
+                }else if (std::holds_alternative<transport_catalogue::detail::RouteItemWalk>(elem.item)){
+                    const auto& item_walk = std::get<transport_catalogue::detail::RouteItemWalk>(elem.item);
+                    item.set_name(item_walk.stop_name.data(), item_walk.stop_name.size());
+                    item.set_span_count(-2);
+                    item.set_time(item_walk.time.count());
+                }else{
+                    const auto& item_bus = std::get<transport_catalogue::detail::RouteItemBus>(elem.item);
+                    item.set_name(item_bus.bus_name.data(), item_bus.bus_name.size());
+                    item.set_span_count(item_bus.span_count);
+                    item.set_time(item_bus.time.count());
+                }
+            }
         }
 
         return result;
@@ -162,80 +215,113 @@ namespace tcs{
 	void Serialize(const transport_catalogue::TransportCatalogue& transport_catalogue,
 			const transport_catalogue::renderer::MapRenderer& renderer,
 			const transport_catalogue::TransportRouter& router,
+			const transport_catalogue::RouteCache& route_cache,
 			std::ostream& output){
 
 		serialize::Catalogue catalogue;
         serialize::RenderSettings render_settings;
         serialize::TransportCatalogue database;
 
-		for (const auto& [name, stop] : transport_catalogue.GetStopsByNames()){
-			*catalogue.add_stop() = SerializeStop(stop);
+		// stops and buses go in id order, so stored id arrays stay valid after loading
+		for (const auto& stop : transport_catalogue.GetStops()){
+			*catalogue.add_stop() = SerializeStop(&stop);
+		}
+
+		for (const auto& bus : transport_catalogue.GetBuses()){
+			*catalogue.add_bus() = SerializeBus(&bus, transport_catalogue.GetBusStopIds(bus.id));
+		}
+
+		for (const uint32_t stop_id : transport_catalogue.GetSortedStopIds()){
+			catalogue.add_sorted_stop_id(stop_id);
 		}
 
-		for (const auto& [name, bus] : transport_catalogue.GetRoutes()){
-			*catalogue.add_bus() = SerializeBus(bus);
+		for (const uint32_t bus_id : transport_catalogue.GetSortedBusIds()){
+			catalogue.add_sorted_bus_id(bus_id);
 		}
 
-        for (const auto& distance_pair : transport_catalogue.GetDistances()){
-            *catalogue.add_distance() = SerializeDistance(distance_pair);
+		*catalogue.mutable_stop_hash() = SerializeNameHash(transport_catalogue.GetStopHash());
+		*catalogue.mutable_bus_hash() = SerializeNameHash(transport_catalogue.GetBusHash());
+
+        const auto& stops = transport_catalogue.GetStops();
+        for (const auto& stop : stops){
+            for (const auto& stop_distance : transport_catalogue.GetStopDistances(stop.id)){
+                if (!stop_distance.is_reverse){
+                    *catalogue.add_distance() = SerializeDistance(stop, stops[stop_distance.stop_id], stop_distance.distance);
+                }
+            }
         }
 
         *database.mutable_catalogue() = catalogue;
         renderer.GetRenderSettings();
 		*database.mutable_render_settings() = SerializeRenderSettings(renderer.GetRenderSettings());
 		*database.mutable_router() = SerializeRouter(router);
+		*database.mutable_route_cache() = SerializeRouteCache(route_cache);
+		database.set_format_version(BASE_FORMAT_VERSION);
 		database.SerializeToOstream(&output);
 	}
 
     void DeserializeStops(const serialize::TransportCatalogue& database,
-                          transport_catalogue::TransportCatalogue& transport_catalogue){
+                          transport_catalogue::CatalogueBuilder& builder){
+        std::vector<transport_catalogue::Stop> stops;
+        stops.reserve(database.catalogue().stop_size());
         for (const serialize::Stop& stop : database.catalogue().stop()){
-            transport_catalogue.AddStop({stop.name(),
-                                         {stop.coordinates(0),
-                                          stop.coordinates(1)}});
+            stops.push_back({stop.name(), {stop.coordinates(0), stop.coordinates(1)}});
         }
+        builder.AddStops(std::move(stops));
     }
 
     void DeserializeDistances(const serialize::TransportCatalogue& database,
-                              transport_catalogue::TransportCatalogue& transport_catalogue){
-        std::unordered_map<std::pair<std::string, std::string>, int,
-                transport_catalogue::detail::StringPairHash> distances;
+                              transport_catalogue::CatalogueBuilder& builder){
+        const size_t stop_count = database.catalogue().stop_size();
+        std::vector<transport_catalogue::CatalogueBuilder::Distance> distances;
+        distances.reserve(database.catalogue().distance_size());
         for (const serialize::DistanceBetweenStops& dbs : database.catalogue().distance()){
-            distances[std::make_pair(dbs.from_stop(), dbs.to_stop())] = dbs.distance();
+            if (dbs.from_stop_id() < stop_count && dbs.to_stop_id() < stop_count){
+                distances.push_back({dbs.from_stop_id(), dbs.to_stop_id(), dbs.distance()});
+            }
         }
-        transport_catalogue.SetDistances(distances);
+        builder.AddDistances(distances);
     }
 
     void DeserializeBuses(const serialize::TransportCatalogue& database,
-                          transport_catalogue::TransportCatalogue& transport_catalogue){
+                          transport_catalogue::CatalogueBuilder& builder){
+        const size_t stop_count = database.catalogue().stop_size();
+        std::vector<transport_catalogue::CatalogueBuilder::Route> routes;
+        routes.reserve(database.catalogue().bus_size());
         for (const serialize::Bus& bus : database.catalogue().bus()){
-            std::vector<std::string> stops(bus.stop_size());
-            std::move(bus.stop().begin(), bus.stop().end(), stops.begin());
-
-            std::vector<transport_catalogue::Stop*> stop_ptrs;
-            stop_ptrs.reserve(stops.size());
-            for (const auto& stop : stops){
-                const auto found_stop = transport_catalogue.FindStop(stop);
-                if (found_stop != nullptr){
-                    stop_ptrs.push_back(found_stop);
+            transport_catalogue::CatalogueBuilder::Route route;
+            route.stop_ids.reserve(bus.stop_id_size());
+            for (const uint32_t stop_id : bus.stop_id()){
+                if (stop_id < stop_count){
+                    route.stop_ids.push_back(stop_id);
                 }
             }
-            transport_catalogue::Bus route;
-            route.is_round = bus.is_round();
-            route.stops = stop_ptrs;
-            route.name = bus.name();
-
-            transport_catalogue.AddRoute(route);
+            route.bus.is_round = bus.is_round();
+            route.bus.name = bus.name();
+            route.bus.factual_length = bus.route_length();
+            route.bus.length_by_coordinates = bus.geo_length();
+            route.bus.curvature = bus.curvature();
+            route.bus.stops_on_route = bus.stop_count();
+            route.bus.unique_stops = bus.unique_stop_count();
+
+            routes.push_back(std::move(route));
         }
+        builder.AddRoutes(std::move(routes));
     }
 
     transport_catalogue::TransportCatalogue Deserialize(const serialize::TransportCatalogue& database){
-        transport_catalogue::TransportCatalogue transport_catalogue;
-        DeserializeStops(database, transport_catalogue);
-        DeserializeDistances(database, transport_catalogue);
-        DeserializeBuses(database, transport_catalogue);
-
-        return transport_catalogue;
+        transport_catalogue::CatalogueBuilder builder(database.catalogue().stop_size(),
+                database.catalogue().bus_size(), false);
+        DeserializeStops(database, builder);
+        DeserializeDistances(database, builder);
+        DeserializeBuses(database, builder);
+        builder.SetSortedIds(
+                {database.catalogue().sorted_stop_id().begin(), database.catalogue().sorted_stop_id().end()},
+                {database.catalogue().sorted_bus_id().begin(), database.catalogue().sorted_bus_id().end()});
+        builder.SetNameHashes(DeserializeNameHash(database.catalogue().stop_hash()),
+                DeserializeNameHash(database.catalogue().bus_hash()));
+
+        return builder.Build();
     }
 
     json::Node ToNode(const serialize::Point& p){
@@ -283,6 +369,42 @@ namespace tcs{
         });
     }
 
+    transport_catalogue::NameHash DeserializeNameHash(const serialize::NameHash& name_hash){
+        return {{name_hash.seed().begin(), name_hash.seed().end()}, {name_hash.value().begin(), name_hash.value().end()}};
+    }
+
+    transport_catalogue::RouteCache DeserializeRouteCache(const serialize::TransportCatalogue& database){
+        const serialize::RouteCache& rc = database.route_cache();
+        std::vector<uint32_t> slots(rc.slot().begin(), rc.slot().end());
+        std::vector<transport_catalogue::detail::CachedRoute> entries;
+        entries.reserve(rc.route_size());
+        for (const serialize::CachedRoute& route : rc.route()){
+            auto& names = transport_catalogue::GetNamePool();
+            transport_catalogue::detail::CachedRoute entry{names.Intern(route.from()), names.Intern(route.to()), std::nullopt};
+            if (route.found()){
+                transport_catalogue::detail::RouteInfo route_info{route.total_time(), {}};
+                route_info.items_.reserve(route.item_size());
+                for (const serialize::RouteItem& item : route.item()){
+                    const std::chrono::duration<double> time(item.time());
+                    if (item.span_count() == -1){
+                        route_info.items_.push_back({transport_catalogue::detail::RouteItemWait{names.Intern(item.name()), time}});
+                    }else if (item.span_count() == -2){
+                        route_info.items_.push_back({transport_catalogue::detail::RouteItemWalk{names.Intern(item.name()), time}});
+                    }else{
+                        route_info.items_.push_back({transport_catalogue::detail::RouteItemBus{
+                                names.Intern(item.name()), item.span_count(), time}});
+                    }
+                }
+                entry.route_info = std::move(route_info);
+            }
+            entries.push_back(std::move(entry));
+        }
+
+        transport_catalogue::RouteCache result;
+        result.SetEntries(std::move(entries), std::move(slots));
+        return result;
+    }
+
     graph::Edge<double> DeserializeEdge(const serialize::Edge& edge){
         graph::Edge<double> result;
         result.from = edge.from();
@@ -292,7 +414,7 @@ namespace tcs{
         return result;
     }
 
-    transport_catalogue::TransportRouter::Graph DeserializeGraph(const serialize::Graph graph){
+    transport_catalogue::TransportRouter::Graph DeserializeGraph(const serialize::Graph& graph){
         transport_catalogue::TransportRouter::Graph result(graph.vertex_count());
         for (const auto& edge : graph.edge()){
             result.AddEdge(DeserializeEdge(edge));
@@ -302,12 +424,27 @@ namespace tcs{
     }
 
     transport_catalogue::TransportRouter DeserializeRouter(const serialize::TransportCatalogue& database){
-        const serialize::RouterSettings& rs = database.router().router_settings();
-        transport_catalogue::TransportRouter router((json::Dict{
-                {{"bus_wait_time"s},{ rs.bus_wait_time() }},
-                {{"bus_velocity"s},{ rs.bus_velocity() }}
-        }));
+        const serialize::Router& router = database.router();
+        transport_catalogue::TransportRouter::Settings settings;
+        settings.bus_wait_time_ = router.router_settings().bus_wait_time();
+        settings.bus_velocity_ = router.router_settings().bus_velocity();
+        settings.pedestrian_velocity_ = router.router_settings().pedestrian_velocity();
+
+        std::vector<transport_catalogue::detail::EdgeInfo> edges;
+        edges.reserve(router.edges_size());
+        for (const serialize::EdgeInfo& edge : router.edges()){
+            edges.push_back({edge.name_id(), static_cast<uint16_t>(edge.span_count())});
+        }
+        const std::vector<std::string> names(router.name().begin(), router.name().end());
+        std::unordered_map<std::string_view, transport_catalogue::detail::Vertexes> stop_to_vertex_id;
+        stop_to_vertex_id.reserve(router.vertexes_size());
+        for (const serialize::Vertexes& vertexes : router.vertexes()){
+            stop_to_vertex_id.emplace(vertexes.name(), transport_catalogue::detail::Vertexes{
+                    static_cast<size_t>(vertexes.start_wait()), static_cast<size_t>(vertexes.end_wait())});
+        }
 
-        return router;
+        // returned as a prvalue, so the router is built right where the caller keeps it
+        return transport_catalogue::TransportRouter(settings, DeserializeGraph(router.graph()), edges, names,
+                stop_to_vertex_id);
     }
 }
@@ -1,42 +1,51 @@
     #pragma once
 
+    #include "catalogue_builder.h"
     #include "transport_catalogue.h"
     #include "map_renderer.h"
     #include "transport_router.h"
+    #include "route_cache.h"
 
     #include <transport_catalogue.pb.h>
 
     // transport catalogue serialization
     namespace tcs{
 
+        // bumped whenever a stored field changes meaning, bases of other versions are not loaded
+        inline constexpr uint32_t BASE_FORMAT_VERSION = 3;
+
         void Serialize(const transport_catalogue::TransportCatalogue& transport_catalogue,
                 const transport_catalogue::renderer::MapRenderer& renderer,
                 const transport_catalogue::TransportRouter& router,
+                const transport_catalogue::RouteCache& route_cache,
                 std::ostream& output);
 
         serialize::Point SerializePoint(const json::Array& p);
         serialize::Color SerializeColor(const json::Node& node);
         serialize::Stop SerializeStop(const transport_catalogue::Stop* stop);
-        serialize::Bus SerializeBus(const transport_catalogue::Bus* bus);
+        serialize::Bus SerializeBus(const transport_catalogue::Bus* bus,
+                transport_catalogue::TransportCatalogue::IdRange stop_ids);
         serialize::RenderSettings SerializeRenderSettings(const json::Node& render_settings);
         serialize::Router SerializeRouter(const transport_catalogue::TransportRouter& router);
         serialize::RouterSettings SerializeRoutingSettings(const
             transport_catalogue::TransportRouter::Settings& routing_settings);
         serialize::Graph SerializeGraph(const transport_catalogue::TransportRouter::Graph& graph);
-        serialize::DistanceBetweenStops SerializeDistance(const std::pair<
-                const std::pair<transport_catalogue::Stop*, transport_catalogue::Stop*>, int>&
-        distance_pair);
-        serialize::Vertexes SerializeVertexes(const transport_catalogue::detail::Vertexes& vertexes);
+        serialize::DistanceBetweenStops SerializeDistance(const transport_catalogue::Stop& from,
+                const transport_catalogue::Stop& to, int distance);
+        serialize::Vertexes SerializeVertexes(std::string_view stop_name,
+                const transport_catalogue::detail::Vertexes& vertexes);
         serialize::Edge SerializeEdge(const graph::Edge<double>& edge);
         serialize::EdgeInfo SerializeEdgeInfo(const transport_catalogue::detail::EdgeInfo& edge_info);
+        serialize::RouteCache SerializeRouteCache(const transport_catalogue::RouteCache& route_cache);
+        serialize::NameHash SerializeNameHash(const transport_catalogue::NameHash& name_hash);
 
 
         void DeserializeStops(const serialize::TransportCatalogue& database,
-                              transport_catalogue::TransportCatalogue& transport_catalogue);
+                              transport_catalogue::CatalogueBuilder& builder);
         void DeserializeDistances(const serialize::TransportCatalogue& database,
-                             transport_catalogue::TransportCatalogue& transport_catalogue);
+                             transport_catalogue::CatalogueBuilder& builder);
         void DeserializeBuses(const serialize::TransportCatalogue& database,
-                         transport_catalogue::TransportCatalogue& transport_catalogue);
+                         transport_catalogue::CatalogueBuilder& builder);
         graph::Edge<double> DeserializeEdge(const serialize::Edge& edge);
         transport_catalogue::TransportCatalogue Deserialize(const serialize::TransportCatalogue& database);
         transport_catalogue::TransportRouter DeserializeRouter(const serialize::TransportCatalogue& database);
@@ -44,4 +53,6 @@
         json::Node ToNode(const serialize::Color& c);
         json::Node ToNode(const google::protobuf::RepeatedPtrField<serialize::Color>& cv);
         json::Node DeserializeRenderSettings(const serialize::TransportCatalogue& database);
+        transport_catalogue::RouteCache DeserializeRouteCache(const serialize::TransportCatalogue& database);
+        transport_catalogue::NameHash DeserializeNameHash(const serialize::NameHash& name_hash);
     }
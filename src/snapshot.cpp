@@ -0,0 +1,10 @@
+#include "snapshot.h"
+
+namespace transport_catalogue{
+
+	CatalogueSnapshot::CatalogueSnapshot(const serialize::TransportCatalogue& database)
+		: transport_catalogue(tcs::Deserialize(database))
+		, map_renderer(tcs::DeserializeRenderSettings(database))
+		, transport_router(tcs::DeserializeRouter(database))
+		, route_cache(tcs::DeserializeRouteCache(database)){}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "map_renderer.h"
+#include "route_cache.h"
+#include "serialization.h"
+#include "snapshot_store.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+
+namespace transport_catalogue{
+
+	// everything requests are answered from, fully built by the constructor;
+	// built in place, the router keeps references into its own graph
+	struct CatalogueSnapshot{
+		explicit CatalogueSnapshot(const serialize::TransportCatalogue& database);
+
+		uint64_t version = 0; // set by SnapshotStore::Publish
+		const TransportCatalogue transport_catalogue;
+		const renderer::MapRenderer map_renderer;
+		const TransportRouter transport_router;
+		const RouteCache route_cache;
+	};
+
+	using CatalogueStore = SnapshotStore<CatalogueSnapshot>;
+}
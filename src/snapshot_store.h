@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace transport_catalogue{
+
+	// publishes immutable snapshots RCU style: readers pin the current snapshot without locks,
+	// the writer swaps in a fully built next version and frees replaced ones no reader pins any more;
+	// Snapshot has a uint64_t version, set while it is published
+	template <typename Snapshot>
+	class SnapshotStore{
+	public:
+		// readers pinning through a slot of their own; further readers pin through a shared count,
+		// which holds back freeing any replaced snapshot until it drops to zero
+		static constexpr size_t MAX_READERS = 64;
+
+		class Pin{
+		public:
+			Pin(Pin&& other) noexcept;
+			Pin(const Pin&) = delete;
+			Pin& operator=(const Pin&) = delete;
+			Pin& operator=(Pin&&) = delete;
+			~Pin();
+
+			const Snapshot* operator->() const{
+				return snapshot_;
+			}
+			const Snapshot& operator*() const{
+				return *snapshot_;
+			}
+			explicit operator bool() const{
+				return snapshot_ != nullptr;
+			}
+
+		private:
+			friend class SnapshotStore;
+			Pin(const SnapshotStore* store, size_t slot, const Snapshot* snapshot);
+
+			const SnapshotStore* store_;
+			size_t slot_; // MAX_READERS when pinned through the shared count
+			const Snapshot* snapshot_;
+		};
+
+		SnapshotStore() = default;
+		SnapshotStore(const SnapshotStore&) = delete;
+		SnapshotStore& operator=(const SnapshotStore&) = delete;
+		~SnapshotStore();
+
+		// empty pin if nothing is published yet; never waits
+		Pin Acquire() const;
+		// the snapshot gets the next version number and replaces the current one, which is retired
+		uint64_t Publish(std::unique_ptr<Snapshot> snapshot);
+		// frees retired snapshots no reader pins any more
+		void Reclaim();
+		size_t GetRetiredCount() const;
+
+	private:
+		std::atomic<const Snapshot*> current_{nullptr};
+		// per reader slot: whether it is taken and the snapshot it pins
+		mutable std::array<std::atomic<bool>, MAX_READERS> slots_in_use_{};
+		mutable std::array<std::atomic<const Snapshot*>, MAX_READERS> pinned_{};
+		mutable std::atomic<size_t> counted_readers_{0};
+
+		mutable std::mutex writer_mutex_;
+		uint64_t last_version_ = 0;
+		std::vector<const Snapshot*> retired_;
+
+		void Release(size_t slot) const;
+	};
+
+	template <typename Snapshot>
+	SnapshotStore<Snapshot>::Pin::Pin(const SnapshotStore* store, size_t slot, const Snapshot* snapshot)
+		: store_(store)
+		, slot_(slot)
+		, snapshot_(snapshot){}
+
+	template <typename Snapshot>
+	SnapshotStore<Snapshot>::Pin::Pin(Pin&& other) noexcept
+		: store_(other.store_)
+		, slot_(other.slot_)
+		, snapshot_(other.snapshot_){
+		other.store_ = nullptr;
+	}
+
+	template <typename Snapshot>
+	SnapshotStore<Snapshot>::Pin::~Pin(){
+		if (store_ != nullptr){
+			store_->Release(slot_);
+		}
+	}
+
+	template <typename Snapshot>
+	SnapshotStore<Snapshot>::~SnapshotStore(){
+		delete current_.load();
+		for (const Snapshot* snapshot : retired_){
+			delete snapshot;
+		}
+	}
+
+	template <typename Snapshot>
+	typename SnapshotStore<Snapshot>::Pin SnapshotStore<Snapshot>::Acquire() const{
+		size_t slot = 0;
+		for (bool expected = false; slot < MAX_READERS; ++slot, expected = false){
+			if (slots_in_use_[slot].compare_exchange_strong(expected, true)){
+				break;
+			}
+		}
+
+		if (slot == MAX_READERS){
+			// the count goes up before current_ is read: a writer that still reads it as zero
+			// has already swapped out every snapshot it frees, so this reader loads a newer one
+			counted_readers_.fetch_add(1);
+			return Pin(this, slot, current_.load());
+		}
+
+		// the writer frees only snapshots it no longer publishes, so once the pin is
+		// visible and current_ still holds the same snapshot, it stays alive
+		const Snapshot* snapshot = current_.load();
+		while (true){
+			pinned_[slot].store(snapshot);
+			const Snapshot* published = current_.load();
+			if (published == snapshot){
+				break;
+			}
+			snapshot = published;
+		}
+		return Pin(this, slot, snapshot);
+	}
+
+	template <typename Snapshot>
+	void SnapshotStore<Snapshot>::Release(size_t slot) const{
+		if (slot == MAX_READERS){
+			counted_readers_.fetch_sub(1);
+			return;
+		}
+		pinned_[slot].store(nullptr);
+		slots_in_use_[slot].store(false);
+	}
+
+	template <typename Snapshot>
+	uint64_t SnapshotStore<Snapshot>::Publish(std::unique_ptr<Snapshot> snapshot){
+		std::lock_guard<std::mutex> guard(writer_mutex_);
+		// no reader sees the snapshot before the swap, so the version is set in place
+		snapshot->version = ++last_version_;
+		const Snapshot* previous = current_.exchange(snapshot.release());
+		if (previous != nullptr){
+			retired_.push_back(previous);
+		}
+		return last_version_;
+	}
+
+	template <typename Snapshot>
+	void SnapshotStore<Snapshot>::Reclaim(){
+		std::lock_guard<std::mutex> guard(writer_mutex_);
+		if (counted_readers_.load() != 0){
+			return;
+		}
+		const auto is_pinned = [this](const Snapshot* snapshot){
+			return std::any_of(pinned_.begin(), pinned_.end(), [snapshot](const auto& pinned){
+				return pinned.load() == snapshot;
+			});
+		};
+		const auto unpinned = std::partition(retired_.begin(), retired_.end(), is_pinned);
+		for (auto it = unpinned; it != retired_.end(); ++it){
+			delete *it;
+		}
+		retired_.erase(unpinned, retired_.end());
+	}
+
+	template <typename Snapshot>
+	size_t SnapshotStore<Snapshot>::GetRetiredCount() const{
+		std::lock_guard<std::mutex> guard(writer_mutex_);
+		return retired_.size();
+	}
+}
@@ -0,0 +1,107 @@
+#define _USE_MATH_DEFINES
+
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transport_catalogue{
+
+	namespace{
+		double Axis(const geo::SpherePoint& point, size_t axis){
+			return axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+		}
+
+		double ChordSq(const geo::SpherePoint& lhs, const geo::SpherePoint& rhs){
+			const double dx = lhs.x - rhs.x;
+			const double dy = lhs.y - rhs.y;
+			const double dz = lhs.z - rhs.z;
+			return dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	void StopIndex::Build(const std::vector<geo::Coordinates>& coordinates){
+		nodes_.clear();
+		nodes_.reserve(coordinates.size());
+		for (size_t stop_id = 0; stop_id < coordinates.size(); ++stop_id){
+			nodes_.push_back({geo::ToSpherePoint(coordinates[stop_id]), static_cast<uint32_t>(stop_id)});
+		}
+		BuildSubtree(0, nodes_.size(), 0);
+	}
+
+	void StopIndex::BuildSubtree(size_t begin, size_t end, size_t depth){
+		if (end - begin < 2){
+			return;
+		}
+		const size_t mid = begin + (end - begin) / 2;
+		const size_t axis = depth % 3;
+		std::nth_element(nodes_.begin() + begin, nodes_.begin() + mid, nodes_.begin() + end,
+				[axis](const Node& lhs, const Node& rhs){
+			return Axis(lhs.point, axis) < Axis(rhs.point, axis);
+		});
+		BuildSubtree(begin, mid, depth + 1);
+		BuildSubtree(mid + 1, end, depth + 1);
+	}
+
+	std::vector<detail::NearbyStop> StopIndex::FindNearest(geo::Coordinates point, size_t max_count, double radius) const{
+		std::vector<detail::NearbyStop> result;
+		if (max_count == 0 || radius < 0 || nodes_.empty()){
+			return result;
+		}
+
+		// great circle radius to chord length, half the circumference covers the whole sphere
+		const double angle = std::min(radius / geo::EARTH_RADIUS, M_PI);
+		const double radius_chord = 2 * std::sin(angle / 2);
+
+		std::vector<Candidate> heap;
+		Search(0, nodes_.size(), 0, geo::ToSpherePoint(point), max_count, radius_chord * radius_chord, heap);
+
+		std::sort_heap(heap.begin(), heap.end());
+		result.reserve(heap.size());
+		for (const Candidate& candidate : heap){
+			const double chord = std::sqrt(candidate.chord_sq);
+			result.push_back({candidate.stop_id, 2 * std::asin(std::min(chord / 2, 1.0)) * geo::EARTH_RADIUS});
+		}
+		return result;
+	}
+
+	void StopIndex::Search(size_t begin, size_t end, size_t depth, const geo::SpherePoint& point, size_t max_count,
+			double radius_chord_sq, std::vector<Candidate>& heap) const{
+		if (begin >= end){
+			return;
+		}
+		const size_t mid = begin + (end - begin) / 2;
+		const Node& node = nodes_[mid];
+
+		// heap is a max-heap of the best candidates found so far
+		const Candidate candidate{ChordSq(point, node.point), node.stop_id};
+		if (candidate.chord_sq <= radius_chord_sq){
+			if (heap.size() < max_count){
+				heap.push_back(candidate);
+				std::push_heap(heap.begin(), heap.end());
+			}else if (candidate < heap.front()){
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = candidate;
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+
+		const double diff = Axis(point, depth % 3) - Axis(node.point, depth % 3);
+		const bool left_first = diff < 0;
+		if (left_first){
+			Search(begin, mid, depth + 1, point, max_count, radius_chord_sq, heap);
+		}else{
+			Search(mid + 1, end, depth + 1, point, max_count, radius_chord_sq, heap);
+		}
+
+		// the far side can only help if the splitting plane is within the current bound
+		const double bound_sq = heap.size() < max_count ? radius_chord_sq : std::min(radius_chord_sq, heap.front().chord_sq);
+		if (diff * diff <= bound_sq){
+			if (left_first){
+				Search(mid + 1, end, depth + 1, point, max_count, radius_chord_sq, heap);
+			}else{
+				Search(begin, mid, depth + 1, point, max_count, radius_chord_sq, heap);
+			}
+		}
+	}
+}
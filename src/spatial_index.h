@@ -0,0 +1,50 @@
+#pragma once
+#include "geo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace transport_catalogue{
+
+	namespace detail{
+		struct NearbyStop{
+			uint32_t stop_id;
+			double distance; // meters along the great circle
+		};
+	}
+
+	// k-d tree over stops as unit vectors; the chord between two points grows
+	// with their great circle distance, so the nearest in space is the nearest on the sphere
+	class StopIndex{
+	public:
+		// stop ids are positions in coordinates
+		void Build(const std::vector<geo::Coordinates>& coordinates);
+		// up to max_count stops within radius meters of the point, nearest first
+		std::vector<detail::NearbyStop> FindNearest(geo::Coordinates point, size_t max_count,
+				double radius = std::numeric_limits<double>::infinity()) const;
+
+	private:
+		struct Node{
+			geo::SpherePoint point;
+			uint32_t stop_id;
+		};
+
+		struct Candidate{
+			double chord_sq;
+			uint32_t stop_id;
+
+			bool operator<(const Candidate& other) const{
+				return chord_sq < other.chord_sq || (chord_sq == other.chord_sq && stop_id < other.stop_id);
+			}
+		};
+
+		// implicit tree: the root of [begin, end) is its middle, split axis is depth % 3
+		std::vector<Node> nodes_;
+
+		void BuildSubtree(size_t begin, size_t end, size_t depth);
+		void Search(size_t begin, size_t end, size_t depth, const geo::SpherePoint& point, size_t max_count,
+				double radius_chord_sq, std::vector<Candidate>& heap) const;
+	};
+}
@@ -0,0 +1,43 @@
+#include "string_pool.h"
+
+#include <algorithm>
+
+namespace transport_catalogue{
+
+	std::string_view StringPool::Intern(std::string_view str){
+		std::lock_guard<std::mutex> guard(mutex_);
+		if (const auto it = strings_.find(str); it != strings_.end()){
+			return *it;
+		}
+		const std::string_view stored(Store(str), str.size());
+		strings_.insert(stored);
+		return stored;
+	}
+
+	size_t StringPool::GetSize() const{
+		std::lock_guard<std::mutex> guard(mutex_);
+		return strings_.size();
+	}
+
+	const char* StringPool::Store(std::string_view str){
+		// long names get a block of their own so the current block keeps its space
+		if (str.size() > BLOCK_SIZE / 4){
+			large_blocks_.push_back(std::make_unique<char[]>(str.size()));
+			std::copy(str.begin(), str.end(), large_blocks_.back().get());
+			return large_blocks_.back().get();
+		}
+		if (blocks_.empty() || block_used_ + str.size() > BLOCK_SIZE){
+			blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+			block_used_ = 0;
+		}
+		char* result = blocks_.back().get() + block_used_;
+		std::copy(str.begin(), str.end(), result);
+		block_used_ += str.size();
+		return result;
+	}
+
+	StringPool& GetNamePool(){
+		static StringPool pool;
+		return pool;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace transport_catalogue{
+
+	// intern table for stop and bus names; each distinct name is stored once
+	// in an arena and the returned views stay valid for the pool lifetime
+	class StringPool{
+	public:
+		StringPool() = default;
+		StringPool(const StringPool&) = delete;
+		StringPool& operator=(const StringPool&) = delete;
+
+		// safe to call concurrently
+		std::string_view Intern(std::string_view str);
+		size_t GetSize() const;
+
+	private:
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+		mutable std::mutex mutex_;
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		std::vector<std::unique_ptr<char[]>> large_blocks_;
+		size_t block_used_ = BLOCK_SIZE;
+		std::unordered_set<std::string_view> strings_;
+
+		const char* Store(std::string_view str);
+	};
+
+	// process-wide pool shared by the catalogue, router, renderer and serialization;
+	// it only grows: names of retired snapshots and dropped shards are kept until exit,
+	// so its size is bounded by the distinct names of every base loaded by the process
+	StringPool& GetNamePool();
+}
@@ -0,0 +1,73 @@
+#include "../geo.h"
+#include "test_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace geo{
+
+	// batch distances of the path through the points compared with ComputeDistance segment by segment
+	double MaxBatchError(const std::vector<Coordinates>& path){
+		std::vector<SpherePoint> points;
+		for (const Coordinates& coordinates : path){
+			points.push_back(ToSpherePoint(coordinates));
+		}
+		std::vector<double> distances(path.size() - 1);
+		ComputePathDistances(points.data(), points.size(), distances.data());
+
+		double max_error = 0.0;
+		for (size_t i = 0; i + 1 < path.size(); ++i){
+			CHECK(std::isfinite(distances[i]) && distances[i] >= 0.0);
+			const double expected = ComputeDistance(path[i], path[i + 1]);
+			// the acos argument of ComputeDistance may round past 1 on very short segments
+			if (!std::isnan(expected)){
+				max_error = std::max(max_error, std::abs(distances[i] - expected));
+			}
+		}
+		return max_error;
+	}
+
+	void TestRandomSegments(){
+		std::mt19937 generator(1);
+		std::uniform_real_distribution<double> lat(-80.0, 80.0);
+		std::uniform_real_distribution<double> lng(-180.0, 180.0);
+		std::vector<Coordinates> path;
+		for (int i = 0; i < 100'000; ++i){
+			path.push_back({lat(generator), lng(generator)});
+		}
+		CHECK(MaxBatchError(path) <= BATCH_DISTANCE_TOLERANCE);
+	}
+
+	void TestShortSegments(){
+		std::mt19937 generator(2);
+		std::uniform_real_distribution<double> lat(-80.0, 80.0);
+		std::uniform_real_distribution<double> lng(-180.0, 180.0);
+		std::uniform_real_distribution<double> shift(-1.0, 1.0);
+		// from about 100 m down to about 1 cm, where both formulas lose precision
+		for (const double degrees : {1e-3, 1e-4, 1e-5, 1e-6, 1e-7}){
+			std::vector<Coordinates> path;
+			for (int i = 0; i < 50'000; ++i){
+				const Coordinates from{lat(generator), lng(generator)};
+				path.push_back(from);
+				path.push_back({from.lat + shift(generator) * degrees, from.lng + shift(generator) * degrees});
+			}
+			CHECK(MaxBatchError(path) <= BATCH_DISTANCE_TOLERANCE);
+		}
+	}
+
+	void TestSamePoint(){
+		const std::vector<Coordinates> path{{55.611087, 37.20829}, {55.611087, 37.20829}};
+		std::vector<SpherePoint> points{ToSpherePoint(path[0]), ToSpherePoint(path[1])};
+		double distance = -1.0;
+		ComputePathDistances(points.data(), points.size(), &distance);
+		CHECK(distance >= 0.0 && distance <= BATCH_DISTANCE_TOLERANCE);
+	}
+}
+
+int main(){
+	geo::TestRandomSegments();
+	geo::TestShortSegments();
+	geo::TestSamePoint();
+}
@@ -0,0 +1,89 @@
+#include "../perfect_hash.h"
+#include "test_utils.h"
+
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace transport_catalogue{
+
+	std::vector<std::string> MakeNames(size_t count){
+		std::vector<std::string> names;
+		for (size_t i = 0; i < count; ++i){
+			names.push_back("Stop "s + std::to_string(i));
+		}
+		return names;
+	}
+
+	void TestEmpty(){
+		const NameHash hash(std::vector<std::string_view>{});
+		CHECK(hash.GetSize() == 0);
+		CHECK(hash.Find("Stop"sv) == NameHash::NO_NAME);
+	}
+
+	void TestDistinctNames(){
+		const std::vector<std::string> names = MakeNames(10'000);
+		const NameHash hash(std::vector<std::string_view>(names.begin(), names.end()));
+		CHECK(hash.GetSize() == names.size());
+		for (uint32_t i = 0; i < names.size(); ++i){
+			CHECK(hash.Find(names[i]) == i);
+		}
+		// other strings land on a real name, which the caller compares
+		CHECK(hash.Find("Unknown stop"sv) < names.size());
+	}
+
+	void TestRepeatedNamesKeepLast(){
+		const std::vector<std::string_view> names{"A"sv, "B"sv, "A"sv, ""sv, "C"sv, "B"sv, ""sv, "A"sv};
+		const NameHash hash(names);
+		CHECK(hash.GetSize() == names.size());
+		CHECK(hash.Find("A"sv) == 7);
+		CHECK(hash.Find("B"sv) == 5);
+		CHECK(hash.Find("C"sv) == 4);
+		CHECK(hash.Find(""sv) == 6);
+		for (const uint32_t value : hash.GetValues()){
+			CHECK(value < names.size());
+		}
+	}
+
+	void TestAllNamesEqual(){
+		const NameHash hash(std::vector<std::string_view>(1000, "A"sv));
+		CHECK(hash.GetSize() == 1000);
+		CHECK(hash.Find("A"sv) == 999);
+	}
+
+	void TestRestoredFromParts(){
+		const std::vector<std::string> names = MakeNames(100);
+		const NameHash hash(std::vector<std::string_view>(names.begin(), names.end()));
+		const NameHash restored(hash.GetSeeds(), hash.GetValues());
+		for (uint32_t i = 0; i < names.size(); ++i){
+			CHECK(restored.Find(names[i]) == i);
+		}
+		CHECK(restored.Covers(names.size()));
+	}
+
+	void TestBadPartsNotCovering(){
+		const std::vector<std::string> names = MakeNames(100);
+		const NameHash hash(std::vector<std::string_view>(names.begin(), names.end()));
+		CHECK(!hash.Covers(names.size() - 1));
+
+		std::vector<uint32_t> values = hash.GetValues();
+		values[0] = static_cast<uint32_t>(names.size());
+		CHECK(!NameHash(hash.GetSeeds(), values).Covers(names.size()));
+
+		const NameHash no_seeds({}, hash.GetValues());
+		CHECK(!no_seeds.Covers(names.size()));
+		CHECK(no_seeds.Find(names[0]) == NameHash::NO_NAME);
+
+		CHECK(NameHash({}, {}).Covers(0));
+	}
+}
+
+int main(){
+	transport_catalogue::TestEmpty();
+	transport_catalogue::TestDistinctNames();
+	transport_catalogue::TestRepeatedNamesKeepLast();
+	transport_catalogue::TestAllNamesEqual();
+	transport_catalogue::TestRestoredFromParts();
+	transport_catalogue::TestBadPartsNotCovering();
+}
@@ -0,0 +1,24 @@
+# runs make_base and process_requests of BINARY on the inputs of CASE
+# and compares the answers with CASE.expected.json
+foreach(base make_base make_update)
+    if(base STREQUAL make_base OR EXISTS ${CASE}.${base}.json)
+        execute_process(COMMAND ${BINARY} make_base INPUT_FILE ${CASE}.${base}.json RESULT_VARIABLE result)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "${base} failed: ${result}")
+        endif()
+    endif()
+endforeach()
+
+execute_process(COMMAND ${BINARY} process_requests INPUT_FILE ${CASE}.process_requests.json
+    OUTPUT_VARIABLE answers RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "process_requests failed: ${result}")
+endif()
+
+file(READ ${CASE}.expected.json expected)
+string(REPLACE "\r\n" "\n" expected "${expected}")
+string(STRIP "${expected}" expected)
+string(STRIP "${answers}" answers)
+if(NOT answers STREQUAL expected)
+    message(FATAL_ERROR "unexpected answers:\n${answers}")
+endif()
@@ -0,0 +1,121 @@
+#include "../snapshot_store.h"
+#include "test_utils.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace transport_catalogue{
+
+	// marks its version as freed, so readers can tell a snapshot freed under them
+	struct TestSnapshot{
+		uint64_t version = 0;
+		std::vector<std::atomic<bool>>* freed;
+
+		explicit TestSnapshot(std::vector<std::atomic<bool>>* freed_versions)
+			: freed(freed_versions){}
+		~TestSnapshot(){
+			(*freed)[version].store(true);
+		}
+	};
+
+	void TestEmptyStore(){
+		const SnapshotStore<TestSnapshot> store;
+		CHECK(!store.Acquire());
+	}
+
+	void TestPinnedSnapshotOutlivesPublish(){
+		std::vector<std::atomic<bool>> freed(3);
+		SnapshotStore<TestSnapshot> store;
+		CHECK(store.Publish(std::make_unique<TestSnapshot>(&freed)) == 1);
+		{
+			const auto pin = store.Acquire();
+			CHECK(pin->version == 1);
+			CHECK(store.Publish(std::make_unique<TestSnapshot>(&freed)) == 2);
+			store.Reclaim();
+			CHECK(!freed[1]);
+			CHECK(pin->version == 1);
+			CHECK(store.Acquire()->version == 2);
+		}
+		store.Reclaim();
+		CHECK(freed[1]);
+		CHECK(store.GetRetiredCount() == 0);
+	}
+
+	void TestReadersBeyondSlots(){
+		std::vector<std::atomic<bool>> freed(3);
+		SnapshotStore<TestSnapshot> store;
+		store.Publish(std::make_unique<TestSnapshot>(&freed));
+		{
+			std::deque<SnapshotStore<TestSnapshot>::Pin> pins;
+			for (size_t i = 0; i < SnapshotStore<TestSnapshot>::MAX_READERS + 10; ++i){
+				pins.push_back(store.Acquire());
+				CHECK(pins.back()->version == 1);
+			}
+			store.Publish(std::make_unique<TestSnapshot>(&freed));
+			for (size_t i = 0; i < SnapshotStore<TestSnapshot>::MAX_READERS; ++i){
+				pins.pop_front();
+			}
+			// only counted readers are left, they still hold back freeing
+			store.Reclaim();
+			CHECK(!freed[1]);
+			CHECK(store.GetRetiredCount() == 1);
+		}
+		store.Reclaim();
+		CHECK(freed[1]);
+	}
+
+	void TestConcurrentPublishAcquireReclaim(){
+		constexpr uint64_t VERSION_COUNT = 2000;
+		// more readers than slots, so some of them pin through the shared count
+		constexpr size_t READER_COUNT = SnapshotStore<TestSnapshot>::MAX_READERS + 4;
+		std::vector<std::atomic<bool>> freed(VERSION_COUNT + 1);
+		SnapshotStore<TestSnapshot> store;
+		store.Publish(std::make_unique<TestSnapshot>(&freed));
+
+		std::atomic<bool> done{false};
+		std::vector<std::thread> readers;
+		for (size_t r = 0; r < READER_COUNT; ++r){
+			readers.emplace_back([&store, &freed, &done](){
+				uint64_t last_version = 0;
+				while (!done.load()){
+					const auto pin = store.Acquire();
+					const uint64_t version = pin->version;
+					CHECK(version >= last_version && version <= VERSION_COUNT);
+					CHECK(!freed[version]);
+					std::this_thread::yield();
+					CHECK(pin->version == version && !freed[version]);
+					last_version = version;
+				}
+			});
+		}
+
+		std::thread writer([&store, &freed, &done](){
+			for (uint64_t version = 2; version <= VERSION_COUNT; ++version){
+				CHECK(store.Publish(std::make_unique<TestSnapshot>(&freed)) == version);
+				store.Reclaim();
+			}
+			done.store(true);
+		});
+
+		writer.join();
+		for (std::thread& reader : readers){
+			reader.join();
+		}
+		store.Reclaim();
+		CHECK(store.GetRetiredCount() == 0);
+		for (uint64_t version = 1; version < VERSION_COUNT; ++version){
+			CHECK(freed[version]);
+		}
+		CHECK(!freed[VERSION_COUNT]);
+	}
+}
+
+int main(){
+	transport_catalogue::TestEmptyStore();
+	transport_catalogue::TestPinnedSnapshotOutlivesPublish();
+	transport_catalogue::TestReadersBeyondSlots();
+	transport_catalogue::TestConcurrentPublishAcquireReclaim();
+}
@@ -0,0 +1,71 @@
+#include "../string_pool.h"
+#include "test_utils.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace transport_catalogue{
+
+	void TestEmptyNameFirst(){
+		StringPool pool;
+		const std::string_view empty = pool.Intern(""sv);
+		CHECK(empty.empty());
+		CHECK(pool.Intern(""sv).data() == empty.data());
+		CHECK(pool.Intern("Stop A"sv) == "Stop A"sv);
+		CHECK(pool.GetSize() == 2);
+	}
+
+	void TestNamesAreStoredOnce(){
+		StringPool pool;
+		std::string name = "Stop A";
+		const std::string_view interned = pool.Intern(name);
+		name[0] = 'X';
+		CHECK(interned == "Stop A"sv);
+		CHECK(pool.Intern("Stop A"sv).data() == interned.data());
+		CHECK(pool.Intern(name) != interned);
+	}
+
+	void TestLongNames(){
+		StringPool pool;
+		const std::string long_name(100'000, 'a');
+		const std::string_view interned = pool.Intern(long_name);
+		CHECK(interned == long_name);
+		CHECK(pool.Intern("b"sv) == "b"sv);
+		CHECK(pool.Intern(long_name).data() == interned.data());
+	}
+
+	void TestConcurrentInterning(){
+		StringPool pool;
+		constexpr size_t THREAD_COUNT = 4;
+		constexpr size_t NAME_COUNT = 10'000;
+		std::vector<std::vector<std::string_view>> interned(THREAD_COUNT);
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < THREAD_COUNT; ++t){
+			threads.emplace_back([&pool, &names = interned[t]](){
+				for (size_t i = 0; i < NAME_COUNT; ++i){
+					names.push_back(pool.Intern("Stop "s + std::to_string(i)));
+				}
+			});
+		}
+		for (std::thread& thread : threads){
+			thread.join();
+		}
+		CHECK(pool.GetSize() == NAME_COUNT);
+		for (size_t i = 0; i < NAME_COUNT; ++i){
+			CHECK(interned[0][i] == "Stop "s + std::to_string(i));
+			for (size_t t = 1; t < THREAD_COUNT; ++t){
+				CHECK(interned[t][i].data() == interned[0][i].data());
+			}
+		}
+	}
+}
+
+int main(){
+	transport_catalogue::TestEmptyNameFirst();
+	transport_catalogue::TestNamesAreStoredOnce();
+	transport_catalogue::TestLongNames();
+	transport_catalogue::TestConcurrentInterning();
+}
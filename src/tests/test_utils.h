@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// stops the test on the first failed condition, naming it and its place
+#define CHECK(condition) \
+	do{ \
+		if (!(condition)){ \
+			std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " #condition "\n"; \
+			std::exit(1); \
+		} \
+	}while (false)
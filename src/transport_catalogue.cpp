@@ -1,104 +1,173 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
+#include <execution>
+#include <iterator>
+#include <limits>
+#include <numeric>
 #include <utility>
 #include <iostream>
 
 namespace transport_catalogue{
 
 	namespace detail{
-		size_t StringPairHash::operator() (const std::pair<std::string, std::string>& stops) const {
-			return hash_s(stops.first) + hash_s(stops.second) * 101;
+		// names sharing a prefix are adjacent in name order
+		template <typename NameById>
+		TransportCatalogue::IdRange FindByPrefix(const std::vector<uint32_t>& sorted_ids, std::string_view prefix,
+				NameById name_by_id){
+			const auto first = std::lower_bound(sorted_ids.begin(), sorted_ids.end(), prefix,
+					[&name_by_id](uint32_t id, std::string_view value){
+				return name_by_id(id) < value;
+			});
+			const auto last = std::partition_point(first, sorted_ids.end(), [&name_by_id, prefix](uint32_t id){
+				return name_by_id(id).substr(0, prefix.size()) == prefix;
+			});
+			return {sorted_ids.data() + (first - sorted_ids.begin()), sorted_ids.data() + (last - sorted_ids.begin())};
 		}
-		size_t StopHash::operator() (const std::pair<Stop*, Stop*>& stops) const {
-			return hash_v(stops.first) + hash_v(stops.second) * 101;
+
+		// ids read from a base are used only if each of 0..count-1 appears once
+		bool IsIdPermutation(const std::vector<uint32_t>& ids, size_t count){
+			if (ids.size() != count){
+				return false;
+			}
+			std::vector<bool> seen(count, false);
+			for (const uint32_t id : ids){
+				if (id >= count || seen[id]){
+					return false;
+				}
+				seen[id] = true;
+			}
+			return true;
 		}
 	}
 
-	void TransportCatalogue::AddRoute(const Bus& bus){
-		buses.push_back(bus);
+	void TransportCatalogue::Reserve(size_t stop_count, size_t bus_count){
+		stops_by_names.reserve(stop_count);
+		routes.reserve(bus_count);
+		stop_points.reserve(stop_count);
+		stop_coordinates.reserve(stop_count);
+		bus_stop_offsets.reserve(bus_count + 1);
+	}
 
+	void TransportCatalogue::AddRoutes(std::vector<Bus> new_buses, std::vector<std::vector<uint32_t>> new_stop_ids,
+			bool compute_statistics){
+		const size_t first_new = buses.size();
+		if (bus_stop_offsets.empty()){
+			bus_stop_offsets.push_back(0);
+		}
+		for (size_t i = 0; i < new_buses.size(); ++i){
+			buses.push_back(std::move(new_buses[i]));
+			buses.back().id = static_cast<uint32_t>(buses.size() - 1);
+			buses.back().name = GetNamePool().Intern(buses.back().name);
+			buses.back().stop_count = new_stop_ids[i].size();
+			routes[buses.back().name] = &buses.back();
+			bus_stop_ids.insert(bus_stop_ids.end(), new_stop_ids[i].begin(), new_stop_ids[i].end());
+			bus_stop_offsets.push_back(static_cast<uint32_t>(bus_stop_ids.size()));
+		}
+
+		// buses only read stops and distances here, so they are independent of each other
+		std::for_each(std::execution::par, buses.begin() + first_new, buses.end(), [this, compute_statistics](Bus& bus){
+			ComputeRouteLengths(bus, compute_statistics);
+		});
+	}
+
+	void TransportCatalogue::ComputeRouteLengths(Bus& bus, bool compute_statistics) const{
 		// calculate length
 		double length_c = 0;
 		double length_f = 0;
+		const size_t route_stop_count = bus.GetRouteStopCount();
+		const IdRange stop_ids = GetBusStopIds(bus.id);
+		std::vector<int>& cumulative_distances = bus.cumulative_distances;
+		cumulative_distances.assign(bus.stop_count == 0 ? 0 : 1, 0);
+		cumulative_distances.reserve(route_stop_count);
 
-		// one stop on route handler
-		if (buses.back().stops.size() == 1){
-			const auto stop = FindStop(buses.back().stops[0]->name);
-			auto found_stop = stop_to_buses.find(stop->name);
-			if (found_stop != stop_to_buses.end()){
-				found_stop->second.insert(&buses.back());
+		// the return leg passes the same segments, their geo distances are symmetric
+		std::vector<double> geo_distances;
+		if (compute_statistics && bus.stop_count > 1){
+			std::vector<geo::SpherePoint> points;
+			points.reserve(bus.stop_count);
+			for (const uint32_t stop_id : stop_ids){
+				points.push_back(stop_points[stop_id]);
 			}
+			geo_distances.resize(points.size() - 1);
+			geo::ComputePathDistances(points.data(), points.size(), geo_distances.data());
 		}
 
 		// if route stops is equal to 1 -> doesnt reach here
-		for(size_t i = 1; i < buses.back().stops.size(); i++){
-			const auto prev_stop = FindStop(buses.back().stops[i - 1]->name);
-			const auto stop = FindStop(buses.back().stops[i]->name);
+		for(size_t i = 1; i < route_stop_count; i++){
+			const uint32_t prev_stop_id = stop_ids.begin()[bus.GetStopPosition(i - 1)];
+			const uint32_t stop_id = stop_ids.begin()[bus.GetStopPosition(i)];
 
-			length_c += geo::ComputeDistance(prev_stop->coordinates, stop->coordinates);
+			if (compute_statistics){
+				length_c += geo_distances[i < bus.stop_count ? i - 1 : route_stop_count - 1 - i];
+			}
 
-			const auto prev_stop_to_stop_distance = GetDistance(std::make_pair(prev_stop, stop));
-			const auto stop_to_prev_stop_distance = GetDistance(std::make_pair(stop, prev_stop));
+			// the opposite direction is already resolved by SetDistances
+			const auto prev_stop_to_stop_distance = GetDistance(prev_stop_id, stop_id);
 
-			if (!prev_stop_to_stop_distance.has_value()
-					&& !stop_to_prev_stop_distance.has_value()){
+			if (!prev_stop_to_stop_distance.has_value()){
 				length_f += -1; // set by authors
+				cumulative_distances.push_back(cumulative_distances.back());
 			}else{
-				if (prev_stop_to_stop_distance.has_value()){
-					length_f += prev_stop_to_stop_distance.value();
-				}else{
-					length_f += stop_to_prev_stop_distance.value();
-				}
-			}
-
-			auto found_stop = stop_to_buses.find(stop->name);
-			if (found_stop != stop_to_buses.end()){
-				found_stop->second.insert(&buses.back());
+				length_f += prev_stop_to_stop_distance.value();
+				cumulative_distances.push_back(cumulative_distances.back() + prev_stop_to_stop_distance.value());
 			}
 		}
 
-		buses.back().factual_length	 = length_f;
-		buses.back().length_by_coordinates = length_c;
-		routes[buses.back().name] = &buses.back();
+		if (compute_statistics){
+			std::vector<uint32_t> unique_stop_ids(stop_ids.begin(), stop_ids.end());
+			std::sort(unique_stop_ids.begin(), unique_stop_ids.end());
+
+			bus.factual_length	 = length_f;
+			bus.length_by_coordinates = length_c;
+			bus.curvature = length_f / length_c;
+			bus.stops_on_route = route_stop_count;
+			bus.unique_stops = std::unique(unique_stop_ids.begin(), unique_stop_ids.end()) - unique_stop_ids.begin();
+		}
 	}
 
 	void TransportCatalogue::AddStop(const Stop& stop){
 		stops.push_back(stop);
+		stops.back().id = static_cast<uint32_t>(stops.size() - 1);
+		stops.back().name = GetNamePool().Intern(stop.name);
 		stops_by_names[stops.back().name] = &stops.back();
-		if (stop_to_buses.find(stops.back().name) == stop_to_buses.end()){
-			stop_to_buses[stops.back().name] = {};
-		}
+		stop_points.push_back(geo::ToSpherePoint(stop.coordinates));
+		stop_coordinates.push_back(stop.coordinates);
 	}
 
-	Stop* TransportCatalogue::FindStop(const std::string_view stop_name) const {
-		if (stops_by_names.count(stop_name) != 0){
-			return stops_by_names.at(stop_name);
+	const Stop* TransportCatalogue::FindStop(const std::string_view stop_name) const {
+		if (!stops.empty() && stop_hash.GetSize() == stops.size()){
+			const Stop& stop = stops[stop_hash.Find(stop_name)];
+			return stop.name == stop_name ? &stop : nullptr;
 		}
-		return nullptr;
+		const auto it = stops_by_names.find(stop_name);
+		return it != stops_by_names.end() ? it->second : nullptr;
 	}
 
-	Bus* TransportCatalogue::FindRoute(const std::string_view bus_name) const {
-		if (routes.count(bus_name) != 0){
-			return routes.at(bus_name);
+	const Bus* TransportCatalogue::FindRoute(const std::string_view bus_name) const {
+		if (!buses.empty() && bus_hash.GetSize() == buses.size()){
+			const Bus& bus = buses[bus_hash.Find(bus_name)];
+			return bus.name == bus_name ? &bus : nullptr;
 		}
-		return nullptr;
+		const auto it = routes.find(bus_name);
+		return it != routes.end() ? it->second : nullptr;
 	}
 
-	std::pair<std::string_view, const std::optional<Bus*>>
+	std::pair<std::string_view, const std::optional<const Bus*>>
 	TransportCatalogue::GetRouteInfo(const std::string_view bus_name) const {
-		if (routes.count(bus_name)){
-			return {bus_name, FindRoute(bus_name)};
+		if (const Bus* bus = FindRoute(bus_name)){
+			return {bus_name, bus};
 		}
 		return {bus_name, std::nullopt};
 	}
 
 	std::pair<std::string_view, const std::optional<std::set<std::string_view>>>
 	TransportCatalogue::GetStopInfo(const std::string_view stop_name) const {
-		if (stop_to_buses.count(stop_name)){
+		const Stop* stop = FindStop(stop_name);
+		if (stop != nullptr){
 			std::set<std::string_view> buses;
-			for (const auto& bus : stop_to_buses.at(stop_name)){
-				buses.insert(bus->name);
+			for (const uint32_t bus_id : GetStopBusIds(stop->id)){
+				buses.insert(GetBusName(bus_id));
 			}
 
 			return {stop_name, buses};
@@ -106,52 +175,239 @@ namespace transport_catalogue{
 		return {stop_name, std::nullopt};
 	}
 
-	void TransportCatalogue::SetDistances(const std::unordered_map<std::pair<std::string, std::string>, int,
-			detail::StringPairHash>& pair_from_to) {
-		for (const auto& [key, val] : pair_from_to) {
-			distances[std::make_pair(FindStop(key.first), FindStop(key.second))] = val;
+	void TransportCatalogue::SetDistances(std::vector<std::vector<detail::StopDistance>> stop_distances) {
+		const auto by_stop_id = [](const detail::StopDistance& lhs, const detail::StopDistance& rhs){
+			return lhs.stop_id < rhs.stop_id;
+		};
+
+		stop_distances.resize(stops.size());
+		size_t distance_count = 0;
+		for (auto& neighbours : stop_distances){
+			std::stable_sort(neighbours.begin(), neighbours.end(), by_stop_id);
+			auto last = neighbours.begin();
+			for (auto it = neighbours.begin(); it != neighbours.end(); ++it){
+				if (last != neighbours.begin() && std::prev(last)->stop_id == it->stop_id){
+					*std::prev(last) = *it;
+				}else{
+					*last++ = *it;
+				}
+			}
+			neighbours.erase(last, neighbours.end());
+			distance_count += neighbours.size();
+		}
+
+		// resolve the reverse lookup once instead of on every query
+		std::vector<std::pair<uint32_t, detail::StopDistance>> reverse_distances;
+		for (uint32_t from_id = 0; from_id < stop_distances.size(); ++from_id){
+			for (const detail::StopDistance& stop_distance : stop_distances[from_id]){
+				const auto& opposite = stop_distances[stop_distance.stop_id];
+				if (!std::binary_search(opposite.begin(), opposite.end(),
+						detail::StopDistance{from_id, 0}, by_stop_id)){
+					reverse_distances.push_back({stop_distance.stop_id, {from_id, stop_distance.distance, true}});
+				}
+			}
+		}
+		for (const auto& [from_id, stop_distance] : reverse_distances){
+			auto& neighbours = stop_distances[from_id];
+			neighbours.insert(std::upper_bound(neighbours.begin(), neighbours.end(), stop_distance, by_stop_id),
+					stop_distance);
+		}
+
+		distances.clear();
+		distances.reserve(distance_count + reverse_distances.size());
+		distance_offsets.assign(1, 0);
+		distance_offsets.reserve(stop_distances.size() + 1);
+		for (const auto& neighbours : stop_distances){
+			distances.insert(distances.end(), neighbours.begin(), neighbours.end());
+			distance_offsets.push_back(static_cast<uint32_t>(distances.size()));
 		}
 	}
 
-	std::optional<int> TransportCatalogue::GetDistance(const std::pair<Stop*, Stop*>& pair_from_to) const {
-		const auto elem = distances.find(pair_from_to);
-		if (elem != distances.end()){
-			return (*elem).second;
+	std::optional<int> TransportCatalogue::GetDistance(uint32_t from_id, uint32_t to_id) const {
+		if (from_id + 1 >= distance_offsets.size()){
+			return {};
+		}
+		for (const detail::StopDistance& stop_distance : GetStopDistances(from_id)){
+			if (stop_distance.stop_id >= to_id){
+				if (stop_distance.stop_id == to_id){
+					return stop_distance.distance;
+				}
+				break;
+			}
 		}
 		return {};
 	}
 
-    std::unordered_map<std::pair<Stop*, Stop*>, int, detail::StopHash> TransportCatalogue::GetDistances() const{
-        return distances;
-    }
-
-    std::unordered_set<Bus*> TransportCatalogue::GetBusesOnStop(const std::string& stop_name) const {
-		return stop_to_buses.at(stop_name);
+	int TransportCatalogue::GetRouteDistance(const Bus& bus, size_t from_index, size_t to_index) const{
+		return bus.cumulative_distances[to_index] - bus.cumulative_distances[from_index];
 	}
 
-	std::map<std::string, Bus*> TransportCatalogue::GetSortedBuses() const{
-		std::map<std::string, Bus*> buses_sorted;
-		for (const auto& [bus_name_view, bus] : routes) {
-			buses_sorted.emplace(std::make_pair(
-					std::string(bus_name_view.begin(), bus_name_view.end()), bus));
+	TransportCatalogue::DistanceRange TransportCatalogue::GetStopDistances(uint32_t stop_id) const{
+		if (stop_id + 1 >= distance_offsets.size()){
+			return {distances.data(), distances.data()};
 		}
-		return buses_sorted;
+		return {distances.data() + distance_offsets[stop_id], distances.data() + distance_offsets[stop_id + 1]};
 	}
 
-	std::deque<Stop> TransportCatalogue::GetStops() const{
+	const std::deque<Stop>& TransportCatalogue::GetStops() const{
 		return stops;
 	}
 
-	std::deque<Bus> TransportCatalogue::GetBuses() const{
+	const std::deque<Bus>& TransportCatalogue::GetBuses() const{
 		return buses;
 	}
 
-	std::unordered_map<std::string_view, Stop*> TransportCatalogue::GetStopsByNames() const{
-		return stops_by_names;
+	void TransportCatalogue::BuildIndex(){
+		const size_t stop_count = stops.size();
+		const size_t bus_count = buses.size();
+
+		std::vector<geo::Coordinates> stop_coordinates;
+		stop_coordinates.reserve(stop_count);
+		for (const Stop& stop : stops){
+			stop_coordinates.push_back(stop.coordinates);
+		}
+		stop_index.Build(stop_coordinates);
+
+		// orderings and hashes set from a base are rebuilt unless they fit the stops and buses
+		if (!detail::IsIdPermutation(sorted_stop_ids, stop_count)){
+			sorted_stop_ids.resize(stop_count);
+			std::iota(sorted_stop_ids.begin(), sorted_stop_ids.end(), 0);
+			std::sort(sorted_stop_ids.begin(), sorted_stop_ids.end(), [this](uint32_t lhs, uint32_t rhs){
+				return GetStopName(lhs) < GetStopName(rhs);
+			});
+		}
+		if (!detail::IsIdPermutation(sorted_bus_ids, bus_count)){
+			sorted_bus_ids.resize(bus_count);
+			std::iota(sorted_bus_ids.begin(), sorted_bus_ids.end(), 0);
+			std::sort(sorted_bus_ids.begin(), sorted_bus_ids.end(), [this](uint32_t lhs, uint32_t rhs){
+				return GetBusName(lhs) < GetBusName(rhs);
+			});
+		}
+
+		if (!stop_hash.Covers(stop_count)){
+			std::vector<std::string_view> stop_names;
+			stop_names.reserve(stop_count);
+			for (const Stop& stop : stops){
+				stop_names.push_back(stop.name);
+			}
+			stop_hash = NameHash(stop_names);
+		}
+		if (!bus_hash.Covers(bus_count)){
+			std::vector<std::string_view> bus_names;
+			bus_names.reserve(bus_count);
+			for (const Bus& bus : buses){
+				bus_names.push_back(bus.name);
+			}
+			bus_hash = NameHash(bus_names);
+		}
+
+		// count distinct buses per stop, then place them; buses are visited in name order
+		constexpr uint32_t NO_BUS = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> last_bus(stop_count, NO_BUS);
+		stop_bus_offsets.assign(stop_count + 1, 0);
+		for (const uint32_t bus_id : sorted_bus_ids){
+			for (const uint32_t stop_id : GetBusStopIds(bus_id)){
+				if (last_bus[stop_id] != bus_id){
+					last_bus[stop_id] = bus_id;
+					++stop_bus_offsets[stop_id + 1];
+				}
+			}
+		}
+		for (size_t stop_id = 0; stop_id < stop_count; ++stop_id){
+			stop_bus_offsets[stop_id + 1] += stop_bus_offsets[stop_id];
+		}
+
+		stop_bus_ids.assign(stop_bus_offsets.back(), 0);
+		std::vector<uint32_t> fill_positions(stop_bus_offsets.begin(), stop_bus_offsets.end() - 1);
+		last_bus.assign(stop_count, NO_BUS);
+		for (const uint32_t bus_id : sorted_bus_ids){
+			for (const uint32_t stop_id : GetBusStopIds(bus_id)){
+				if (last_bus[stop_id] != bus_id){
+					last_bus[stop_id] = bus_id;
+					stop_bus_ids[fill_positions[stop_id]++] = bus_id;
+				}
+			}
+		}
+
+		// no routes are added any more and names are found through the hashes
+		stops_by_names = {};
+		routes = {};
+		stop_points = {};
+	}
+
+	void TransportCatalogue::SetSortedIds(std::vector<uint32_t> stop_ids, std::vector<uint32_t> bus_ids){
+		sorted_stop_ids = std::move(stop_ids);
+		sorted_bus_ids = std::move(bus_ids);
+	}
+
+	void TransportCatalogue::SetNameHashes(NameHash stop_names, NameHash bus_names){
+		stop_hash = std::move(stop_names);
+		bus_hash = std::move(bus_names);
+	}
+
+	const NameHash& TransportCatalogue::GetStopHash() const{
+		return stop_hash;
+	}
+
+	const NameHash& TransportCatalogue::GetBusHash() const{
+		return bus_hash;
+	}
+
+	TransportCatalogue::IdRange TransportCatalogue::GetSortedStopIds() const{
+		return {sorted_stop_ids.data(), sorted_stop_ids.data() + sorted_stop_ids.size()};
+	}
+
+	TransportCatalogue::IdRange TransportCatalogue::GetSortedBusIds() const{
+		return {sorted_bus_ids.data(), sorted_bus_ids.data() + sorted_bus_ids.size()};
+	}
+
+	TransportCatalogue::IdRange TransportCatalogue::FindStopsByPrefix(std::string_view prefix) const{
+		return detail::FindByPrefix(sorted_stop_ids, prefix, [this](uint32_t stop_id){
+			return GetStopName(stop_id);
+		});
+	}
+
+	TransportCatalogue::IdRange TransportCatalogue::FindBusesByPrefix(std::string_view prefix) const{
+		return detail::FindByPrefix(sorted_bus_ids, prefix, [this](uint32_t bus_id){
+			return GetBusName(bus_id);
+		});
+	}
+
+	std::vector<detail::NearbyStop> TransportCatalogue::FindNearbyStops(geo::Coordinates point, size_t max_count,
+			double radius) const{
+		return stop_index.FindNearest(point, max_count, radius);
+	}
+
+	size_t TransportCatalogue::GetStopCount() const{
+		return stops.size();
+	}
+
+	size_t TransportCatalogue::GetBusCount() const{
+		return buses.size();
+	}
+
+	std::string_view TransportCatalogue::GetStopName(uint32_t stop_id) const{
+		return stops[stop_id].name;
+	}
+
+	std::string_view TransportCatalogue::GetBusName(uint32_t bus_id) const{
+		return buses[bus_id].name;
+	}
+
+	geo::Coordinates TransportCatalogue::GetStopCoordinates(uint32_t stop_id) const{
+		return stop_coordinates[stop_id];
+	}
+
+	TransportCatalogue::IdRange TransportCatalogue::GetBusStopIds(uint32_t bus_id) const{
+		return {bus_stop_ids.data() + bus_stop_offsets[bus_id], bus_stop_ids.data() + bus_stop_offsets[bus_id + 1]};
+	}
+
+	uint32_t TransportCatalogue::GetRouteStopId(const Bus& bus, size_t route_position) const{
+		return bus_stop_ids[bus_stop_offsets[bus.id] + bus.GetStopPosition(route_position)];
 	}
 
-	std::unordered_map<std::string_view, Bus*> TransportCatalogue::GetRoutes() const{
-		return routes;
+	TransportCatalogue::IdRange TransportCatalogue::GetStopBusIds(uint32_t stop_id) const{
+		return {stop_bus_ids.data() + stop_bus_offsets[stop_id], stop_bus_ids.data() + stop_bus_offsets[stop_id + 1]};
 	}
 }
 
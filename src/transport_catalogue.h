@@ -1,7 +1,13 @@
 #pragma once
 #include "geo.h"
 #include "domain.h"
+#include "perfect_hash.h"
+#include "ranges.h"
+#include "spatial_index.h"
+#include "string_pool.h"
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -15,41 +21,97 @@
 namespace transport_catalogue{
 
 	namespace detail{
-		struct StringPairHash {
-			size_t operator () (const std::pair<std::string, std::string>&) const;
-			std::hash<std::string> hash_s;
-		};
-
-		struct StopHash {
-			size_t operator() (const std::pair<Stop*, Stop*>&) const;
-			std::hash<const void*> hash_v;
+		struct StopDistance {
+			uint32_t stop_id;
+			int distance;
+			bool is_reverse = false; // copied from the opposite direction, not given in the input
 		};
 	}
 
+	// filled by CatalogueBuilder and read-only afterwards
 	class TransportCatalogue{
 	public:
-		void AddStop(const Stop& stop);
-		void AddRoute(const Bus& bus);
-		Stop* FindStop(const std::string_view stop_name) const;
-		Bus* FindRoute(const std::string_view bus_name) const;
-		std::pair<std::string_view, const std::optional<Bus*>> GetRouteInfo(const std::string_view bus_name) const;
+		using IdRange = ranges::Range<const uint32_t*>;
+		using DistanceRange = ranges::Range<const detail::StopDistance*>;
+
+		// a single probe of the name hash once BuildIndex is done, the name maps before that
+		const Stop* FindStop(const std::string_view stop_name) const;
+		const Bus* FindRoute(const std::string_view bus_name) const;
+		std::pair<std::string_view, const std::optional<const Bus*>> GetRouteInfo(const std::string_view bus_name) const;
 		std::pair<std::string_view, const std::optional<std::set<std::string_view>>> GetStopInfo(const std::string_view stop_name) const;
-		void SetDistances(const std::unordered_map<std::pair<std::string, std::string>, int, detail::StringPairHash>& input);
-		std::optional<int> GetDistance(const std::pair<Stop*, Stop*>& pair_from_to) const;
-        std::unordered_map<std::pair<Stop*, Stop*>, int, detail::StopHash> GetDistances() const;
-		std::unordered_set<Bus*> GetBusesOnStop(const std::string& stop_name) const;
-		std::map<std::string, Bus*> GetSortedBuses() const;
-		std::deque<Stop> GetStops() const;
-		std::deque<Bus> GetBuses() const;
-		std::unordered_map<std::string_view, Stop*> GetStopsByNames() const;
-		std::unordered_map<std::string_view, Bus*> GetRoutes() const;
+		std::optional<int> GetDistance(uint32_t from_id, uint32_t to_id) const;
+		int GetRouteDistance(const Bus& bus, size_t from_index, size_t to_index) const;
+		// distances from the stop sorted by destination id
+		DistanceRange GetStopDistances(uint32_t stop_id) const;
+		const std::deque<Stop>& GetStops() const;
+		const std::deque<Bus>& GetBuses() const;
+
+		// dense storage, ids are positions in GetStops() and GetBuses()
+		size_t GetStopCount() const;
+		size_t GetBusCount() const;
+		std::string_view GetStopName(uint32_t stop_id) const;
+		std::string_view GetBusName(uint32_t bus_id) const;
+		geo::Coordinates GetStopCoordinates(uint32_t stop_id) const;
+		// stop ids of the bus as given, the return leg of a linear route is not stored
+		IdRange GetBusStopIds(uint32_t bus_id) const;
+		// stop id at a position along the whole route, the return leg of a linear route included
+		uint32_t GetRouteStopId(const Bus& bus, size_t route_position) const;
+		// bus ids of the stop in bus name order
+		IdRange GetStopBusIds(uint32_t stop_id) const;
+		// name orderings
+		IdRange GetSortedStopIds() const;
+		IdRange GetSortedBusIds() const;
+		// ids of the names starting with the prefix, a subrange of the name orderings
+		IdRange FindStopsByPrefix(std::string_view prefix) const;
+		IdRange FindBusesByPrefix(std::string_view prefix) const;
+		// minimal perfect hashes of stop and bus names to ids
+		const NameHash& GetStopHash() const;
+		const NameHash& GetBusHash() const;
+		// up to max_count stops within radius meters of the point, nearest first
+		std::vector<detail::NearbyStop> FindNearbyStops(geo::Coordinates point, size_t max_count,
+				double radius = std::numeric_limits<double>::infinity()) const;
 
 	private:
+		friend class CatalogueBuilder;
+
+		void Reserve(size_t stop_count, size_t bus_count);
+		void AddStop(const Stop& stop);
+		// stop ids of every new bus as given; statistics already present in the bus,
+		// e.g. read from a base, may be kept as is; lengths of the added routes are computed in parallel
+		void AddRoutes(std::vector<Bus> new_buses, std::vector<std::vector<uint32_t>> new_stop_ids,
+				bool compute_statistics);
+		// destinations by source stop id in any order, the last of repeated ones is kept
+		void SetDistances(std::vector<std::vector<detail::StopDistance>> stop_distances);
+		// built once all stops and routes are added
+		void BuildIndex();
+		// name orderings and hashes are computed by BuildIndex unless set beforehand
+		void SetSortedIds(std::vector<uint32_t> stop_ids, std::vector<uint32_t> bus_ids);
+		void SetNameHashes(NameHash stop_names, NameHash bus_names);
+		void ComputeRouteLengths(Bus& bus, bool compute_statistics) const;
+
 		std::deque<Stop> stops;
 		std::deque<Bus> buses;
-		std::unordered_map<std::string_view, Bus*> routes;
-		std::unordered_map<std::string_view, Stop*> stops_by_names;
-		std::unordered_map<std::string_view, std::unordered_set<Bus*>> stop_to_buses;
-		std::unordered_map<std::pair<Stop*, Stop*>, int, detail::StopHash> distances;
+		// name lookup while stops and routes are added, released by BuildIndex for the name hashes
+		std::unordered_map<std::string_view, const Bus*> routes;
+		std::unordered_map<std::string_view, const Stop*> stops_by_names;
+		// by stop id, filled on AddStop for route length computation and released by BuildIndex
+		std::vector<geo::SpherePoint> stop_points;
+		// by stop id
+		std::vector<geo::Coordinates> stop_coordinates;
+		// stop ids of every bus as given, CSR layout by bus id
+		std::vector<uint32_t> bus_stop_ids;
+		std::vector<uint32_t> bus_stop_offsets;
+		// CSR by source stop id, a missing direction is filled from the opposite one
+		std::vector<detail::StopDistance> distances;
+		std::vector<uint32_t> distance_offsets;
+
+		// distinct bus ids of every stop in bus name order, CSR layout
+		std::vector<uint32_t> stop_bus_ids;
+		std::vector<uint32_t> stop_bus_offsets;
+		std::vector<uint32_t> sorted_stop_ids;
+		std::vector<uint32_t> sorted_bus_ids;
+		NameHash stop_hash;
+		NameHash bus_hash;
+		StopIndex stop_index;
 	};
 }
@@ -1,25 +1,44 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 namespace transport_catalogue{
 
 	TransportRouter::TransportRouter(const json::Node& routing_settings){
 		if (!routing_settings.IsNull()){
 			const json::Dict& settings_map = routing_settings.AsMap();
-			settings_ = {settings_map.at("bus_wait_time").AsInt(), settings_map.at("bus_velocity").AsDouble()};
+			settings_.bus_wait_time_ = settings_map.at("bus_wait_time").AsInt();
+			settings_.bus_velocity_ = settings_map.at("bus_velocity").AsDouble();
+			if (settings_map.count("pedestrian_velocity")){
+				settings_.pedestrian_velocity_ = settings_map.at("pedestrian_velocity").AsDouble();
+			}
 		}
 	}
 
+	TransportRouter::TransportRouter(const Settings& settings, Graph graph, const std::vector<detail::EdgeInfo>& edges,
+			const std::vector<std::string>& names,
+			const std::unordered_map<std::string_view, detail::Vertexes>& stop_to_vertex_id)
+		: settings_(settings){
+		SetGraph(std::move(graph));
+		SetEdges(edges, names);
+		SetVertexes(stop_to_vertex_id);
+		Build();
+	}
+
 	std::vector<detail::RouteItem> TransportRouter::MakeItemsByEdgeIds(const std::vector<graph::EdgeId>& edge_ids) const{
 		std::vector<detail::RouteItem> items;
 		items.reserve(edge_ids.size());
 		for (const auto id : edge_ids){
 			const detail::EdgeInfo& edge_info = edges_[id];
+			const std::chrono::duration<double> time(graph_->GetEdge(id).weight);
 			detail::RouteItem route_item;
-			if (edge_info.span_count == -1){
-				detail::RouteItemWait item_wait = {edge_info.name, edge_info.time};
+			if (edge_info.span_count == 0){
+				detail::RouteItemWait item_wait = {names_[edge_info.name_id], time};
 				route_item.item = item_wait;
 			}else{
-				detail::RouteItemBus item_bus = {edge_info.name, edge_info.span_count, edge_info.time};
+				detail::RouteItemBus item_bus = {names_[edge_info.name_id], edge_info.span_count, time};
 				route_item.item = item_bus;
 			}
 			items.push_back(std::move(route_item));
@@ -28,12 +47,12 @@ namespace transport_catalogue{
 		return items;
 	}
 
-	std::optional<detail::RouteInfo> TransportRouter::GetRouteInfo(const std::string& stop_name_from,
-			const std::string& stop_name_to) const{
-		const auto stop_from_it = stop_to_vertex_id_.find(stop_name_from);
-		const auto stop_to_it = stop_to_vertex_id_.find(stop_name_to);
-		if (stop_from_it != stop_to_vertex_id_.end() && stop_to_it != stop_to_vertex_id_.end()){
-			const auto route = router_->BuildRoute(stop_from_it->second.start_wait, stop_to_it->second.start_wait);
+	std::optional<detail::RouteInfo> TransportRouter::GetRouteInfo(std::string_view stop_name_from,
+			std::string_view stop_name_to) const{
+		const detail::Vertexes* stop_from = FindVertexes(stop_name_from);
+		const detail::Vertexes* stop_to = FindVertexes(stop_name_to);
+		if (stop_from != nullptr && stop_to != nullptr){
+			const auto route = BuildRoute(stop_from->start_wait, stop_to->start_wait);
 			if (route){
 				return detail::RouteInfo{route->weight, MakeItemsByEdgeIds(route->edges)};
 			}
@@ -41,71 +60,190 @@ namespace transport_catalogue{
 		return std::nullopt;
 	}
 
-	void TransportRouter::AddStop(const std::string& stop_name){
-		if (!stop_to_vertex_id_.count(stop_name)){
-			const size_t sz = stop_to_vertex_id_.size();
-			stop_to_vertex_id_[stop_name] = { sz * 2, sz * 2 + 1 };
+	std::optional<detail::RouteInfo> TransportRouter::GetRouteInfo(const std::vector<detail::StopAccess>& stops_from,
+			const std::vector<detail::StopAccess>& stops_to, std::optional<double> direct_walk_time) const{
+		// every pair is a lookup in the all-pairs tables, only the best route is unpacked
+		double best_time = direct_walk_time.value_or(std::numeric_limits<double>::infinity());
+		const detail::StopAccess* best_from = nullptr;
+		const detail::StopAccess* best_to = nullptr;
+		for (const detail::StopAccess& stop_from : stops_from){
+			const detail::Vertexes* vertexes_from = FindVertexes(stop_from.stop_name);
+			if (vertexes_from == nullptr){
+				continue;
+			}
+			for (const detail::StopAccess& stop_to : stops_to){
+				const detail::Vertexes* vertexes_to = FindVertexes(stop_to.stop_name);
+				if (vertexes_to == nullptr){
+					continue;
+				}
+				const auto weight = GetRouteWeight(vertexes_from->start_wait, vertexes_to->start_wait);
+				if (weight && stop_from.walk_time + *weight + stop_to.walk_time < best_time){
+					best_time = stop_from.walk_time + *weight + stop_to.walk_time;
+					best_from = &stop_from;
+					best_to = &stop_to;
+				}
+			}
+		}
+
+		if (best_from == nullptr){
+			if (direct_walk_time){
+				return detail::RouteInfo{*direct_walk_time,
+						{{detail::RouteItemWalk{{}, std::chrono::duration<double>(*direct_walk_time)}}}};
+			}
+			return std::nullopt;
+		}
+
+		const auto route = BuildRoute(FindVertexes(best_from->stop_name)->start_wait,
+				FindVertexes(best_to->stop_name)->start_wait);
+		detail::RouteInfo result{best_time, {}};
+		result.items_.reserve(route->edges.size() + 2);
+		if (best_from->walk_time > 0){
+			result.items_.push_back({detail::RouteItemWalk{best_from->stop_name,
+					std::chrono::duration<double>(best_from->walk_time)}});
+		}
+		for (detail::RouteItem& item : MakeItemsByEdgeIds(route->edges)){
+			result.items_.push_back(std::move(item));
+		}
+		if (best_to->walk_time > 0){
+			result.items_.push_back({detail::RouteItemWalk{best_to->stop_name,
+					std::chrono::duration<double>(best_to->walk_time)}});
 		}
+		return result;
 	}
 
-	void TransportRouter::AddWaitEdge(const std::string& stop_name){
-		detail::EdgeInfo edge{
-			{
-			stop_to_vertex_id_[stop_name].start_wait,
-			stop_to_vertex_id_[stop_name].end_wait,
-			static_cast<double>(settings_.bus_wait_time_)
-			},
-			stop_name,
-			-1,
-			static_cast<std::chrono::duration<double>>(settings_.bus_wait_time_)
-		};
+	double TransportRouter::GetWalkTime(double distance) const{
+		const double TO_MINUTES = 0.06;
+		return distance / settings_.pedestrian_velocity_ * TO_MINUTES;
+	}
+
+	uint32_t TransportRouter::GetNameId(std::string_view name){
+		if (const auto it = name_ids_.find(name); it != name_ids_.end()){
+			return it->second;
+		}
+		const std::string_view interned = GetNamePool().Intern(name);
+		names_.push_back(interned);
+		return name_ids_[interned] = static_cast<uint32_t>(names_.size() - 1);
+	}
+
+	const detail::Vertexes* TransportRouter::FindVertexes(std::string_view stop_name) const{
+		if (!stop_vertexes_.empty()){
+			const auto& [name, vertexes] = stop_vertexes_[stop_hash_.Find(stop_name)];
+			return name == stop_name ? &vertexes : nullptr;
+		}
+		const auto it = stop_to_vertex_id_.find(stop_name);
+		return it != stop_to_vertex_id_.end() ? &it->second : nullptr;
+	}
 
-		edges_.push_back(std::move(edge));
+	void TransportRouter::AddEdge(const graph::Edge<double>& edge, const detail::EdgeInfo& edge_info){
+		graph_->AddEdge(edge);
+		edges_.push_back(edge_info);
 	}
 
-	void TransportRouter::AddBusEdge(const std::string& stop_name_from, const std::string& stop_name_to,
-			const std::string& bus_name, const int span_count, const int dist){
+	detail::Vertexes TransportRouter::AddStop(std::string_view stop_name){
+		if (const auto it = stop_to_vertex_id_.find(stop_name); it != stop_to_vertex_id_.end()){
+			return it->second;
+		}
+		if (!graph_){
+			graph_.emplace();
+		}
+		const size_t start_wait = graph_->AddVertex();
+		const size_t end_wait = graph_->AddVertex();
+		return stop_to_vertex_id_[GetNamePool().Intern(stop_name)] = { start_wait, end_wait };
+	}
+
+	void TransportRouter::AddWaitEdge(std::string_view stop_name){
+		const detail::Vertexes& vertexes = stop_to_vertex_id_.at(stop_name);
+		AddEdge({vertexes.start_wait, vertexes.end_wait, static_cast<double>(settings_.bus_wait_time_)},
+				{GetNameId(stop_name), 0});
+	}
+
+	void TransportRouter::AddBusEdge(std::string_view stop_name_from, std::string_view stop_name_to,
+			std::string_view bus_name, const int span_count, const int dist){
+		const detail::RouterEdge edge = MakeBusEdge(stop_to_vertex_id_.at(stop_name_from), stop_to_vertex_id_.at(stop_name_to),
+				GetNameId(bus_name), span_count, dist);
+		AddEdge(edge.edge, edge.info);
+	}
+
+	detail::RouterEdge TransportRouter::MakeBusEdge(const detail::Vertexes& stop_from, const detail::Vertexes& stop_to,
+			uint32_t bus_name_id, const int span_count, const int dist) const{
 		const double TO_MINUTES = 0.06;
-		detail::EdgeInfo edge{
+		if (span_count <= 0 || span_count > std::numeric_limits<uint16_t>::max()){
+			throw std::out_of_range("span count does not fit into edge storage");
+		}
+		return {
 			{
-				stop_to_vertex_id_[stop_name_from].end_wait,
-				stop_to_vertex_id_[stop_name_to].start_wait,
+				stop_from.end_wait,
+				stop_to.start_wait,
 				dist / settings_.bus_velocity_ * TO_MINUTES
 			},
-			bus_name,
-			span_count,
-			static_cast<std::chrono::duration<double>>(dist / settings_.bus_velocity_ * TO_MINUTES)
+			{bus_name_id, static_cast<uint16_t>(span_count)}
 		};
-
-		edges_.push_back(std::move(edge));
 	}
 
-	void TransportRouter::AddEdgesToGraph(){
-		for (const auto& edge_info : edges_){
-			graph_->AddEdge(edge_info.edge);
+	void TransportRouter::AddEdges(const std::vector<detail::RouterEdge>& edges){
+		edges_.reserve(edges_.size() + edges.size());
+		for (const detail::RouterEdge& edge : edges){
+			AddEdge(edge.edge, edge.info);
 		}
 	}
 
 	void TransportRouter::BuildGraph(){
 		if (!graph_){
-			graph_ = std::move(Graph(stop_to_vertex_id_.size() * 2));
+			graph_.emplace(stop_to_vertex_id_.size() * 2);
 		}
-		AddEdgesToGraph();
 	}
 
-    void TransportRouter::SetEdges(const std::vector<detail::EdgeInfo>& edges){
+    void TransportRouter::SetEdges(const std::vector<detail::EdgeInfo>& edges, const std::vector<std::string>& names){
         edges_ = edges;
+        names_.clear();
+        name_ids_.clear();
+        for (const std::string& name : names){
+            names_.push_back(GetNamePool().Intern(name));
+            name_ids_.emplace(names_.back(), static_cast<uint32_t>(names_.size() - 1));
+        }
     }
 
-    void TransportRouter::SetVertexes(const std::unordered_map<std::string,
-                     detail::Vertexes, std::hash<std::string_view>>& stop_to_vertex_id){
-        stop_to_vertex_id_ = stop_to_vertex_id;
+    void TransportRouter::SetVertexes(const std::unordered_map<std::string_view, detail::Vertexes>& stop_to_vertex_id){
+        stop_to_vertex_id_.clear();
+        for (const auto& [stop_name, vertexes] : stop_to_vertex_id){
+            stop_to_vertex_id_.emplace(GetNamePool().Intern(stop_name), vertexes);
+        }
     }
 
 	void TransportRouter::BuildRouter(){
 		if (!router_ && graph_){
-			router_.emplace(*graph_);
+			// routes are only asked between stops, end_wait vertices are intermediates
+			std::vector<graph::VertexId> stop_vertices;
+			stop_vertices.reserve(stop_to_vertex_id_.size());
+			for (const auto& [stop_name, vertexes] : stop_to_vertex_id_){
+				stop_vertices.push_back(vertexes.start_wait);
+			}
+			std::sort(stop_vertices.begin(), stop_vertices.end());
+
+			stop_vertexes_.assign(stop_to_vertex_id_.begin(), stop_to_vertex_id_.end());
+			std::vector<std::string_view> stop_names;
+			stop_names.reserve(stop_vertexes_.size());
+			for (const auto& [stop_name, vertexes] : stop_vertexes_){
+				stop_names.push_back(stop_name);
+			}
+			stop_hash_ = NameHash(stop_names);
+
+			router_.emplace(*graph_, stop_vertices);
+		}
+	}
+
+	std::optional<graph::RouteInfo<double>> TransportRouter::BuildRoute(graph::VertexId from, graph::VertexId to) const{
+		if (!router_){
+			return std::nullopt;
+		}
+		return router_->BuildRoute(from, to);
+	}
+
+	std::optional<double> TransportRouter::GetRouteWeight(graph::VertexId from, graph::VertexId to) const{
+		if (!router_){
+			return std::nullopt;
 		}
+		return router_->GetRouteWeight(from, to);
 	}
 
 	void TransportRouter::Build(){
@@ -114,11 +252,10 @@ namespace transport_catalogue{
 	}
 
     void TransportRouter::SetGraph(graph::DirectedWeightedGraph<double> graph){
-        graph_ = graph;
+        graph_ = std::move(graph);
     }
 
-    std::unordered_map<std::string, detail::Vertexes, std::hash<std::string_view>>
-        TransportRouter::GetStopToVertexId() const{
+    const std::unordered_map<std::string_view, detail::Vertexes>& TransportRouter::GetStopToVertexId() const{
         return stop_to_vertex_id_;
     }
 
@@ -133,7 +270,11 @@ namespace transport_catalogue{
         return {};
     }
 
-    std::vector<detail::EdgeInfo> TransportRouter::GetEdges() const{
+    const std::vector<detail::EdgeInfo>& TransportRouter::GetEdges() const{
         return edges_;
     }
+
+    const std::vector<std::string_view>& TransportRouter::GetNames() const{
+        return names_;
+    }
 }
@@ -6,26 +6,35 @@
 #include <variant>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <chrono>
+#include <cstdint>
 
 namespace transport_catalogue{
 
 	namespace detail{
+		// names are views into GetNamePool()
 		struct RouteItemWait{
-			std::string stop_name;
+			std::string_view stop_name;
 			std::chrono::duration<double> time;
 		};
 
 		struct RouteItemBus{
-			std::string bus_name;
+			std::string_view bus_name;
 			int span_count;
 			std::chrono::duration<double> time;
 		};
 
+		// walk between a stop and a point of the request, or between the two points if stop_name is empty
+		struct RouteItemWalk{
+			std::string_view stop_name;
+			std::chrono::duration<double> time;
+		};
+
 		struct RouteItem{
-			std::variant<RouteItemWait, RouteItemBus> item;
+			std::variant<RouteItemWait, RouteItemBus, RouteItemWalk> item;
 		};
 
 		struct RouteInfo{
@@ -38,11 +47,21 @@ namespace transport_catalogue{
 			size_t end_wait;
 		};
 
+		// route item data of a graph edge; endpoints and time are the graph edge itself
 		struct EdgeInfo{
+			uint32_t name_id = 0;    // stop name for wait edges, bus name for bus edges
+			uint16_t span_count = 0; // 0 for wait edges
+		};
+
+		// stop a route may start or end at and the walk between it and the request point
+		struct StopAccess{
+			std::string_view stop_name;
+			double walk_time = 0.0;
+		};
+
+		struct RouterEdge{
 			graph::Edge<double> edge;
-			std::string name;
-			int span_count = -1;
-			std::chrono::duration<double> time{0.0};
+			EdgeInfo info;
 		};
 	}
 
@@ -57,32 +76,67 @@ namespace transport_catalogue{
 		struct Settings{
 			int bus_wait_time_ = 6;
 			double bus_velocity_ = 40.0;
+			double pedestrian_velocity_ = 4.0;
 		};
 
-		std::optional<detail::RouteInfo> GetRouteInfo(const std::string& stop_name_from, const std::string& stop_name_to) const;
-		void AddStop(const std::string& stop_name);
-		void AddWaitEdge(const std::string& stop_name);
-		void AddBusEdge(const std::string& stop_name_from, const std::string& stop_name_to,
-				const std::string& bus_name, const int span_count, const int dist);
+		// a router loaded from a base, built in place
+		TransportRouter(const Settings& settings, Graph graph, const std::vector<detail::EdgeInfo>& edges,
+				const std::vector<std::string>& names,
+				const std::unordered_map<std::string_view, detail::Vertexes>& stop_to_vertex_id);
+		// the built router refers to graph_, so the object stays where it was built
+		TransportRouter(const TransportRouter&) = delete;
+		TransportRouter& operator=(const TransportRouter&) = delete;
+
+		// stops a coordinate is snapped to
+		static constexpr size_t SNAP_STOP_COUNT = 3;
+		// meters a coordinate is snapped over, and the longest walk straight between two coordinates
+		static constexpr double MAX_WALK_DISTANCE = 2000.0;
+
+		std::optional<detail::RouteInfo> GetRouteInfo(std::string_view stop_name_from, std::string_view stop_name_to) const;
+		// best route over all pairs of start and end stops, walks included;
+		// walking straight there wins if it is faster
+		std::optional<detail::RouteInfo> GetRouteInfo(const std::vector<detail::StopAccess>& stops_from,
+				const std::vector<detail::StopAccess>& stops_to, std::optional<double> direct_walk_time) const;
+		double GetWalkTime(double distance) const;
+		// vertexes of the stop, added unless the stop is known
+		detail::Vertexes AddStop(std::string_view stop_name);
+		void AddWaitEdge(std::string_view stop_name);
+		void AddBusEdge(std::string_view stop_name_from, std::string_view stop_name_to,
+				std::string_view bus_name, const int span_count, const int dist);
+		// safe to call concurrently once all stops and names are added
+		detail::RouterEdge MakeBusEdge(const detail::Vertexes& stop_from, const detail::Vertexes& stop_to,
+				uint32_t bus_name_id, const int span_count, const int dist) const;
+		void AddEdges(const std::vector<detail::RouterEdge>& edges);
+		uint32_t GetNameId(std::string_view name);
 		void Build();
 		void BuildGraph();
 		void BuildRouter();
-        void SetEdges(const std::vector<detail::EdgeInfo>& edges);
-        void SetVertexes(const std::unordered_map<std::string, detail::Vertexes, std::hash<std::string_view>>& stop_to_vertex_id);
+        void SetEdges(const std::vector<detail::EdgeInfo>& edges, const std::vector<std::string>& names);
+        void SetVertexes(const std::unordered_map<std::string_view, detail::Vertexes>& stop_to_vertex_id);
         void SetGraph(graph::DirectedWeightedGraph<double> graph);
-        std::unordered_map<std::string, detail::Vertexes, std::hash<std::string_view>> GetStopToVertexId() const;
+        const std::unordered_map<std::string_view, detail::Vertexes>& GetStopToVertexId() const;
         Settings GetRoutingSettings() const;
         Graph GetGraph() const;
-        std::vector<detail::EdgeInfo> GetEdges() const;
+        const std::vector<detail::EdgeInfo>& GetEdges() const;
+        const std::vector<std::string_view>& GetNames() const;
 
 	private:
 		Settings settings_;
 		std::optional<Graph> graph_ = std::nullopt;
 		std::optional<GraphRouter> router_ = std::nullopt;
-		std::unordered_map<std::string, detail::Vertexes, std::hash<std::string_view>> stop_to_vertex_id_;
+		// keys and names are interned in GetNamePool()
+		std::unordered_map<std::string_view, detail::Vertexes> stop_to_vertex_id_;
 		std::vector<detail::EdgeInfo> edges_;
+		std::vector<std::string_view> names_;
+		std::unordered_map<std::string_view, uint32_t> name_ids_;
+		// stop lookup of the built router, a minimal perfect hash into stop_vertexes_
+		NameHash stop_hash_;
+		std::vector<std::pair<std::string_view, detail::Vertexes>> stop_vertexes_;
 
-		void AddEdgesToGraph();
+		void AddEdge(const graph::Edge<double>& edge, const detail::EdgeInfo& edge_info);
+		const detail::Vertexes* FindVertexes(std::string_view stop_name) const;
+		std::optional<graph::RouteInfo<double>> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+		std::optional<double> GetRouteWeight(graph::VertexId from, graph::VertexId to) const;
 		std::vector<detail::RouteItem> MakeItemsByEdgeIds(const std::vector<graph::EdgeId>& edge_ids) const;
 	};
 }